@@ -0,0 +1,796 @@
+// Benchmarks for the GL-free maze core: generation, path finding and collision.
+// Needs no window or GL context. Results go to stdout as JSON (default) or CSV,
+// one record per operation, maze size and seed, so runs can be compared between commits.
+//
+// Every record carries the maze ID and a hash of the generated wall grid; for a given
+// seed, size and generator both must be the same on every platform. scratch_bytes is the
+// memory an operation used besides the wall grid, peak_rss_kb the process peak so far.
+// Each group of operations has a bench function of its own below; maze_bench --help lists
+// the options and the records they add.
+
+#include "CollisionBatch.h"
+#include "MazeGrid.h"
+#include "MazeStreamWriter.h"
+
+#include <sys/resource.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+struct Result {
+    string operation;
+    int width;
+    int height;
+    uint64_t seed;
+    string rng;
+    string algorithm;
+    int threads;           // worker threads of tiled generation, 1 otherwise
+    uint64_t mazeId;
+    uint64_t gridHash;
+    size_t items;          // cells generated or searched, or collision queries
+    double seconds;
+    string unit;           // throughput unit: cells/s, rows/s or queries/s
+    size_t gridBytes;
+    size_t scratchBytes;   // generation scratch memory besides the grid
+    long peakRssKB;
+};
+
+// clearance of the swept circles from the wall center lines, in cells (a walking body plus half a wall)
+const float bodyRadius = 0.125f;
+
+// peak resident set size of the process so far, in KB
+long peakRssKB()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;   // bytes on macOS
+#else
+    return usage.ru_maxrss;          // KB on Linux
+#endif
+}
+
+string hex(uint64_t value)
+{
+    stringstream text;
+    text << setw(16) << setfill('0') << std::hex << value;
+    return text.str();
+}
+
+vector<int> parseList(const string& text)
+{
+    vector<int> values;
+    stringstream list(text);
+    string value;
+    while (getline(list, value, ',')) {
+        if (atoi(value.c_str()) > 0)
+            values.push_back(atoi(value.c_str()));
+    }
+    return values;
+}
+
+// comma separated 64-bit seeds; any value, 0 included, false (with a message) on anything else
+bool parseSeeds(const string& text, vector<uint64_t>& seeds)
+{
+    seeds.clear();
+    stringstream list(text);
+    string value;
+    while (getline(list, value, ',')) {
+        char* end = nullptr;
+        errno = 0;
+        unsigned long long seed = strtoull(value.c_str(), &end, 10);
+        if (value.empty() || value[0] == '-' || *end != '\0' || errno == ERANGE) {
+            cerr << "maze_bench: invalid seed " << value << endl;
+            return false;
+        }
+        seeds.push_back(seed);
+    }
+    return true;
+}
+
+// 32-bit seed of the query and move generators; both halves of the maze seed count
+uint32_t querySeed(uint64_t seed)
+{
+    return static_cast<uint32_t>(seed ^ (seed >> 32));
+}
+
+// comma separated algorithm names, false (with a message) on an unknown name
+bool parseAlgorithms(const string& text, vector<MazeGenerator::Algorithm>& algorithms)
+{
+    algorithms.clear();
+    stringstream list(text);
+    string name;
+    while (getline(list, name, ',')) {
+        MazeGenerator::Algorithm algorithm;
+        if (!MazeGenerator::findAlgorithm(name, algorithm)) {
+            cerr << "maze_bench: unknown algorithm " << name << endl;
+            return false;
+        }
+        algorithms.push_back(algorithm);
+    }
+    return true;
+}
+
+// drop a file from the page cache so the next read comes from disk (best effort, Linux only)
+void evictFromCache(const string& path)
+{
+#ifdef __linux__
+    int descriptor = open(path.c_str(), O_RDONLY);
+    if (descriptor >= 0) {
+        fdatasync(descriptor);
+        posix_fadvise(descriptor, 0, 0, POSIX_FADV_DONTNEED);
+        close(descriptor);
+    }
+#else
+    (void)path;
+#endif
+}
+
+double secondsSince(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+void printJson(const vector<Result>& results)
+{
+    cout << "{\n  \"benchmark\": \"maze_bench\",\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        cout << "    {\"operation\": \"" << r.operation << "\", \"width\": " << r.width
+             << ", \"height\": " << r.height << ", \"seed\": " << r.seed << ", \"rng\": \"" << r.rng
+             << "\", \"algorithm\": \"" << r.algorithm << "\", \"threads\": " << r.threads << ", \"maze_id\": \"" << hex(r.mazeId) << "\", \"grid_hash\": \"" << hex(r.gridHash)
+             << "\", \"items\": " << r.items
+             << ", \"seconds\": " << r.seconds << ", \"throughput\": " << r.items / r.seconds
+             << ", \"unit\": \"" << r.unit << "\", \"grid_bytes\": " << r.gridBytes
+             << ", \"scratch_bytes\": " << r.scratchBytes << ", \"peak_rss_kb\": " << r.peakRssKB << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    cout << "  ]\n}" << endl;
+}
+
+void printCsv(const vector<Result>& results)
+{
+    cout << "operation,width,height,seed,rng,algorithm,threads,maze_id,grid_hash,items,seconds,throughput,unit,grid_bytes,scratch_bytes,peak_rss_kb\n";
+    for (const Result& r : results) {
+        cout << r.operation << "," << r.width << "," << r.height << "," << r.seed << "," << r.rng << ","
+             << r.algorithm << "," << r.threads << "," << hex(r.mazeId) << "," << hex(r.gridHash) << "," << r.items << ","
+             << r.seconds << "," << r.items / r.seconds << "," << r.unit << "," << r.gridBytes << ","
+             << r.scratchBytes << "," << r.peakRssKB << "\n";
+    }
+    cout.flush();
+}
+
+// command line options
+struct Options {
+    vector<int> sizes = { 64, 256, 1024, 2048 };
+    vector<uint64_t> seeds = { 1, 2, 3 };
+    vector<MazeGenerator::Algorithm> algorithms;
+    Rng::Kind rngKind = Rng::XOSHIRO256;
+    string rngName = "xoshiro";
+    size_t queryCount = 1000000;
+    vector<int> threadCounts;
+    int tileSize = 256;
+    int chunkSize = 64;
+    vector<int> agentCounts = { 1000, 10000, 100000 };
+    int goalCount = 4;
+    string mazeFile;
+    int streamWidth = 0;
+    int streamHeight = 0;
+    string streamFile = "maze_stream.maze";
+    string format = "json";
+};
+
+// the options and the records so far
+struct Bench {
+    Options options;
+    vector<Result> results;
+    size_t collisions = 0;   // printed at the end so the queries are not optimized away
+    size_t hints = 0;
+};
+
+// query points of one maze size and seed, drawn before timing and shared by its generators
+struct Queries {
+    vector<float> xs;               // points spread uniformly over the maze, in cells
+    vector<float> zs;
+    vector<uint32_t> fromCells;     // random cell pairs made from the points
+    vector<uint32_t> toCells;
+};
+
+// one generated maze and the fields its records share
+struct BenchMaze {
+    MazeGrid grid;
+    int size;
+    size_t cells;
+    uint64_t seed;
+    MazeGenerator::Algorithm algorithm;
+    string algorithmName;
+    uint64_t mazeId;
+    uint64_t gridHash;
+    size_t gridBytes;
+    size_t scratchBytes;            // generation scratch
+    double generateSeconds;
+};
+
+void printUsage(ostream& out)
+{
+    out << "Usage: maze_bench [options]\n"
+        << "  --sizes 64,256,1024       square maze sizes (default 64,256,1024,2048)\n"
+        << "  --seeds 1,2,3             64-bit seeds, 0 included; every size runs every seed\n"
+        << "  --algorithms dfs,...      generators (default all); generateMaze per generator\n"
+        << "  --rng xoshiro|pcg         random number generator\n"
+        << "  --queries N               query points per maze (default 1000000) for the path index\n"
+        << "                            (buildPathIndex, pathLengthIndexed, pathIndexed against a search\n"
+        << "                            per query, pathLengthSearch, fewer on large mazes), the flow\n"
+        << "                            fields (buildFlowField, flowFieldSteer: every point steers for a\n"
+        << "                            few ticks), the exit field (buildExitField, exitDirection,\n"
+        << "                            exitFieldRepair opening and closing random walls) and collision\n"
+        << "                            (checkCollision; moveCircle and moveCircles sweep by up to a\n"
+        << "                            quarter cell; resolveCircles and resolveCirclesScalar push circles\n"
+        << "                            of random radii out of the walls on the best and the scalar kernel)\n"
+        << "  --threads 1,2,4           adds generateTiled on each thread count, with the speedup and\n"
+        << "                            parallel efficiency over one thread\n"
+        << "  --tile N                  tile cells per side of tiled generation (default 256)\n"
+        << "  --chunk N                 chunk cells per side of buildChunkGraph and pathChunked, on the\n"
+        << "                            search's queries (default 64)\n"
+        << "  --agents 1000,10000       solvePaths batch sizes (default 1000,10000,100000); batches whose\n"
+        << "                            paths would take over 1 GB are skipped\n"
+        << "  --goals N                 goals of the agents and the flow fields (default 4)\n"
+        << "  --maze-file path          adds saveFile, and the cold start of mapping the file (loadFile)\n"
+        << "                            and of also reading every wall (loadFileTouched); the file is\n"
+        << "                            dropped from the page cache before each and removed afterwards\n"
+        << "  --stream WxH              adds streamEller, an Eller maze of that size streamed to\n"
+        << "                            --stream-file (removed afterwards) in rows/s; grid_bytes is the\n"
+        << "                            file size\n"
+        << "  --stream-file path        (default maze_stream.maze)\n"
+        << "  --format json|csv         output format (default json)\n";
+}
+
+// parse the command line, false (with a message) on a bad option
+bool parseOptions(int argc, char** argv, Options& options)
+{
+    for (int i = 0; i < MazeGenerator::ALGORITHM_COUNT; i++) {
+        options.algorithms.push_back(static_cast<MazeGenerator::Algorithm>(i));
+    }
+
+    for (int i = 1; i < argc; i++) {
+        string option = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (option == "--sizes" && hasValue) {
+            options.sizes = parseList(argv[++i]);
+        }
+        else if (option == "--seeds" && hasValue) {
+            if (!parseSeeds(argv[++i], options.seeds)) {
+                return false;
+            }
+        }
+        else if (option == "--queries" && hasValue) {
+            options.queryCount = strtoull(argv[++i], nullptr, 10);
+        }
+        else if (option == "--rng" && hasValue) {
+            options.rngKind = string(argv[++i]) == "pcg" ? Rng::PCG32 : Rng::XOSHIRO256;
+            options.rngName = options.rngKind == Rng::PCG32 ? "pcg" : "xoshiro";
+        }
+        else if (option == "--format" && hasValue) {
+            options.format = argv[++i];
+        }
+        else if (option == "--threads" && hasValue) {
+            options.threadCounts = parseList(argv[++i]);
+        }
+        else if (option == "--tile" && hasValue) {
+            options.tileSize = max(1, atoi(argv[++i]));
+        }
+        else if (option == "--chunk" && hasValue) {
+            options.chunkSize = max(4, atoi(argv[++i]));
+        }
+        else if (option == "--agents" && hasValue) {
+            options.agentCounts = parseList(argv[++i]);
+        }
+        else if (option == "--goals" && hasValue) {
+            options.goalCount = max(1, atoi(argv[++i]));
+        }
+        else if (option == "--stream" && hasValue) {
+            if (sscanf(argv[++i], "%dx%d", &options.streamWidth, &options.streamHeight) != 2 ||
+                options.streamWidth <= 0 || options.streamHeight <= 0) {
+                cerr << "maze_bench: invalid stream size, expected WIDTHxHEIGHT" << endl;
+                return false;
+            }
+        }
+        else if (option == "--maze-file" && hasValue) {
+            options.mazeFile = argv[++i];
+        }
+        else if (option == "--stream-file" && hasValue) {
+            options.streamFile = argv[++i];
+        }
+        else if (option == "--algorithms" && hasValue) {
+            if (!parseAlgorithms(argv[++i], options.algorithms)) {
+                return false;
+            }
+        }
+        else {
+            printUsage(cerr);
+            return false;
+        }
+    }
+    return true;
+}
+
+// add a record of the maze with the fields all its operations share; the caller may adjust it
+Result& record(Bench& bench, const BenchMaze& maze, const string& operation, size_t items, double seconds,
+               const string& unit, size_t scratchBytes)
+{
+    bench.results.push_back({ operation, maze.size, maze.size, maze.seed,
+                              bench.options.rngName, maze.algorithmName, 1, maze.mazeId, maze.gridHash, items, seconds,
+                              unit, maze.gridBytes, scratchBytes, peakRssKB() });
+    return bench.results.back();
+}
+
+// query points and cell pairs of a maze size, drawn from the seed
+void makeQueries(int size, uint64_t seed, size_t queryCount, Queries& queries)
+{
+    mt19937 queryRng(querySeed(seed));
+    uniform_real_distribution<float> coordinate(0.0f, static_cast<float>(size));
+    queries.xs.resize(queryCount);
+    queries.zs.resize(queryCount);
+    queries.fromCells.resize(queryCount);
+    queries.toCells.resize(queryCount);
+    for (size_t q = 0; q < queryCount; q++) {
+        queries.xs[q] = coordinate(queryRng);
+        queries.zs[q] = coordinate(queryRng);
+        // The float distribution can round up to size itself, one column or row past the grid
+        uint32_t column = min(static_cast<uint32_t>(queries.xs[q]), static_cast<uint32_t>(size - 1));
+        uint32_t row = min(static_cast<uint32_t>(queries.zs[q]), static_cast<uint32_t>(size - 1));
+        queries.fromCells[q] = row * size + column;
+        queries.toCells[q] = column * size + row;
+    }
+}
+
+// generateMaze, which also fills in the maze's shared fields
+void benchGeneration(Bench& bench, BenchMaze& maze)
+{
+    maze.grid.setAlgorithm(maze.algorithm);
+    auto start = chrono::steady_clock::now();
+    maze.grid.generateMaze();
+    maze.generateSeconds = secondsSince(start);
+    maze.gridBytes = maze.grid.getWalls().memoryBytes();
+    maze.scratchBytes = maze.grid.getScratchBytes();
+    maze.mazeId = maze.grid.getMazeId();
+    maze.gridHash = maze.grid.getWalls().hash();
+    record(bench, maze, "generateMaze", maze.cells, maze.generateSeconds, "cells/s", maze.scratchBytes);
+}
+
+// cold start from a maze file against generating again; false when the file does not load back
+bool benchMazeFile(Bench& bench, const BenchMaze& maze)
+{
+    const string& mazeFile = bench.options.mazeFile;
+    auto start = chrono::steady_clock::now();
+    bool saved = maze.grid.saveFile(mazeFile);
+    double saveSeconds = secondsSince(start);
+    if (!saved) {
+        return false;
+    }
+    record(bench, maze, "saveFile", maze.cells, saveSeconds, "cells/s", 0);
+
+    evictFromCache(mazeFile);
+    MazeGrid loaded;
+    start = chrono::steady_clock::now();
+    bool mapped = loaded.loadFile(mazeFile);
+    double loadSeconds = secondsSince(start);
+    record(bench, maze, "loadFile", maze.cells, loadSeconds, "cells/s", 0).mazeId = loaded.getMazeId();
+
+    evictFromCache(mazeFile);
+    MazeGrid touched;
+    start = chrono::steady_clock::now();
+    mapped = touched.loadFile(mazeFile) && mapped;
+    uint64_t loadedHash = touched.getWalls().hash();
+    double touchedSeconds = secondsSince(start);
+    Result& touchedRecord = record(bench, maze, "loadFileTouched", maze.cells, touchedSeconds, "cells/s", 0);
+    touchedRecord.mazeId = touched.getMazeId();
+    touchedRecord.gridHash = loadedHash;
+    remove(mazeFile.c_str());
+
+    if (!mapped || loadedHash != maze.gridHash) {
+        cerr << "maze_bench: " << mazeFile << " did not load back the same maze" << endl;
+        return false;
+    }
+    cerr << "maze_bench:   cold start " << loadSeconds * 1e3 << " ms mapped, " << touchedSeconds * 1e3
+         << " ms read, generating " << maze.generateSeconds * 1e3 << " ms" << endl;
+    return true;
+}
+
+// tiled generation on each thread count; the maze is the same for every count
+void benchTiled(Bench& bench, const BenchMaze& maze)
+{
+    double singleThreadSeconds = 0.0;
+    for (int threads : bench.options.threadCounts) {
+        MazeGrid tiled(maze.size, maze.size, maze.seed, bench.options.rngKind);
+        tiled.setAlgorithm(maze.algorithm);
+        tiled.setTiling(bench.options.tileSize, threads);
+
+        auto start = chrono::steady_clock::now();
+        tiled.generateMaze();
+        double tiledSeconds = secondsSince(start);
+        Result& tiledRecord = record(bench, maze, "generateTiled", maze.cells, tiledSeconds, "cells/s",
+                                     tiled.getScratchBytes());
+        tiledRecord.threads = threads;
+        tiledRecord.mazeId = tiled.getMazeId();
+        tiledRecord.gridHash = tiled.getWalls().hash();
+
+        if (threads == 1)
+            singleThreadSeconds = tiledSeconds;
+        if (singleThreadSeconds > 0.0) {
+            double speedup = singleThreadSeconds / tiledSeconds;
+            cerr << "maze_bench:   tiled " << tiled.getTileSize() << " on " << threads << " threads: "
+                 << speedup << "x, efficiency " << speedup / threads << endl;
+        }
+    }
+}
+
+// the solution path, the path index against a breadth-first search per query, and hierarchical path
+// finding on the same queries; false when they disagree on a path length
+bool benchPaths(Bench& bench, BenchMaze& maze, const Queries& queries)
+{
+    MazeGrid& grid = maze.grid;
+    int size = maze.size;
+    size_t queryCount = queries.fromCells.size();
+    const vector<uint32_t>& fromCells = queries.fromCells;
+    const vector<uint32_t>& toCells = queries.toCells;
+
+    auto start = chrono::steady_clock::now();
+    grid.generatePath();
+    double pathSeconds = secondsSince(start);
+    record(bench, maze, "generatePath", maze.cells, pathSeconds, "cells/s", maze.scratchBytes);
+
+    start = chrono::steady_clock::now();
+    bool indexed = grid.buildPathIndex();
+    double indexSeconds = secondsSince(start);
+    size_t indexBytes = grid.getPathIndex().memoryBytes();
+    if (!indexed) {
+        cerr << "maze_bench: " << maze.algorithmName << " did not make a perfect maze" << endl;
+        return false;
+    }
+    record(bench, maze, "buildPathIndex", maze.cells, indexSeconds, "cells/s", indexBytes);
+
+    vector<uint32_t> lengths(queryCount);
+    start = chrono::steady_clock::now();
+    grid.pathLengths(fromCells.data(), toCells.data(), queryCount, lengths.data());
+    double indexQuerySeconds = secondsSince(start);
+    record(bench, maze, "pathLengthIndexed", queryCount, indexQuerySeconds, "queries/s", indexBytes);
+
+    vector<pair<int, int>> path;
+    size_t pathLengthSum = 0;
+    size_t pathCount = min(queryCount, size_t(1000));
+    start = chrono::steady_clock::now();
+    for (size_t q = 0; q < pathCount; q++) {
+        grid.findPath(fromCells[q] % size, fromCells[q] / size, toCells[q] % size, toCells[q] / size, path);
+        pathLengthSum += path.size();
+    }
+    double indexPathSeconds = secondsSince(start);
+    record(bench, maze, "pathIndexed", pathLengthSum, indexPathSeconds, "cells/s", indexBytes);
+
+    // The search is slow on large mazes, so it gets fewer queries; they must agree with the index
+    size_t searchCount = min(queryCount, max(size_t(16), (size_t(1) << 24) / maze.cells));
+    PathSolver solver;
+    start = chrono::steady_clock::now();
+    for (size_t q = 0; q < searchCount; q++) {
+        solver.findPath(grid.getWalls(), fromCells[q] % size, fromCells[q] / size, toCells[q] % size,
+                        toCells[q] / size, path);
+        if (path.size() - 1 != lengths[q]) {
+            cerr << "maze_bench: path index and search disagree on query " << q << endl;
+            return false;
+        }
+    }
+    double searchSeconds = secondsSince(start);
+    record(bench, maze, "pathLengthSearch", searchCount, searchSeconds, "queries/s", solver.getScratchBytes());
+
+    // Hierarchical path finding; the paths must be as short as the search's
+    ChunkGraph chunks;
+    start = chrono::steady_clock::now();
+    chunks.build(grid.getWalls(), bench.options.chunkSize);
+    double chunkBuildSeconds = secondsSince(start);
+    record(bench, maze, "buildChunkGraph", maze.cells, chunkBuildSeconds, "cells/s", chunks.memoryBytes());
+
+    start = chrono::steady_clock::now();
+    for (size_t q = 0; q < searchCount; q++) {
+        chunks.findPath(grid.getWalls(), fromCells[q] % size, fromCells[q] / size, toCells[q] % size,
+                        toCells[q] / size, path);
+        if (path.size() - 1 != lengths[q]) {
+            cerr << "maze_bench: chunk graph and search disagree on query " << q << endl;
+            return false;
+        }
+    }
+    double chunkSeconds = secondsSince(start);
+    record(bench, maze, "pathChunked", searchCount, chunkSeconds, "queries/s", chunks.memoryBytes());
+    cerr << "maze_bench:   chunk graph " << chunks.getNodeCount() << " nodes, " << chunks.memoryBytes() / 1024
+         << " KB against " << solver.getScratchBytes() / 1024 << " KB searching, "
+         << chunkSeconds / searchCount * 1e3 << " ms against " << searchSeconds / searchCount * 1e3
+         << " ms per query" << endl;
+    cerr << "maze_bench:   path index " << indexBytes / maze.cells << " bytes per cell, queries "
+         << (searchSeconds / searchCount) / (indexQuerySeconds / queryCount) << "x faster than searching" << endl;
+    return true;
+}
+
+// goal g of the agents and the flow fields: the exit first, then cells drawn from the seed
+uint32_t goalCell(const BenchMaze& maze, int g)
+{
+    return g == 0 ? static_cast<uint32_t>(maze.cells - 1)
+                  : static_cast<uint32_t>(Rng::mix(maze.seed * 31 + g) % maze.cells);
+}
+
+// batches of agents heading for a few goals, random starts drawn before timing
+void benchAgents(Bench& bench, BenchMaze& maze)
+{
+    int goalCount = bench.options.goalCount;
+    uint64_t batchSteps = 0;
+    for (int agents : bench.options.agentCounts) {
+        if (batchSteps * agents / 4 > (uint64_t(1) << 30)) {
+            cerr << "maze_bench:   skipping " << agents << " agents, their paths would take over 1 GB" << endl;
+            break;
+        }
+        mt19937 agentRng(querySeed(maze.seed));
+        vector<PathRequest> requests(agents);
+        for (int a = 0; a < agents; a++) {
+            requests[a].start = static_cast<uint32_t>(agentRng() % maze.cells);
+            requests[a].goal = goalCell(maze, a % goalCount);
+        }
+        auto start = chrono::steady_clock::now();
+        const PathBatch& batch = maze.grid.solvePaths(requests.data(), requests.size());
+        double batchSeconds = secondsSince(start);
+        record(bench, maze, "solvePaths", static_cast<size_t>(agents), batchSeconds, "queries/s", batch.memoryBytes());
+        cerr << "maze_bench:   " << agents << " agents, " << batch.getSearchCount() << " searches, "
+             << batch.getStepCount() / agents << " steps per path, " << batch.memoryBytes() / 1024 << " KB" << endl;
+        batchSteps = batch.getStepCount() / agents + 1;
+    }
+}
+
+// crowd steering through flow fields toward the agents' goals: the exit's field is built (a miss), the
+// other goals' fields are built untimed, then every query point steps with one lookup per tick
+void benchFlowFields(Bench& bench, BenchMaze& maze, const Queries& queries)
+{
+    MazeGrid& grid = maze.grid;
+    int size = maze.size;
+    int goalCount = bench.options.goalCount;
+    size_t queryCount = queries.fromCells.size();
+
+    auto start = chrono::steady_clock::now();
+    grid.getFlowField(size - 1, size - 1);
+    double flowSeconds = secondsSince(start);
+    record(bench, maze, "buildFlowField", maze.cells, flowSeconds, "cells/s", grid.getFlowFields().memoryBytes());
+
+    const int ticks = 4;
+    const ptrdiff_t cellStep[5] = { -static_cast<ptrdiff_t>(size), size, -1, 1, 0 };
+    vector<uint32_t> agentCells(queries.fromCells);
+    vector<uint32_t> goalCells(goalCount);
+    for (int g = 0; g < goalCount; g++) {
+        goalCells[g] = goalCell(maze, g);
+        grid.getFlowField(goalCells[g] % size, goalCells[g] / size);
+    }
+    vector<const uint8_t*> goalFields(goalCount);
+    start = chrono::steady_clock::now();
+    for (int tick = 0; tick < ticks; tick++) {
+        for (int g = 0; g < goalCount; g++) {
+            goalFields[g] = grid.getFlowField(goalCells[g] % size, goalCells[g] / size);
+        }
+        for (size_t q = 0; q < queryCount; q++) {
+            uint8_t direction = goalFields[q % goalCount][agentCells[q]];
+            agentCells[q] += static_cast<uint32_t>(cellStep[direction < 4 ? direction : 4]);
+        }
+    }
+    double steerSeconds = secondsSince(start);
+    for (size_t q = 0; q < queryCount; q++) {
+        bench.hints += agentCells[q];
+    }
+    const FlowFieldCache& flowFields = grid.getFlowFields();
+    record(bench, maze, "flowFieldSteer", queryCount * ticks, steerSeconds, "queries/s", flowFields.memoryBytes());
+    cerr << "maze_bench:   flow fields " << flowFields.getFieldCount() << " cached, " << flowFields.getHitCount()
+         << " hits, " << flowFields.getMissCount() << " misses, " << flowFields.getEvictionCount()
+         << " evictions, " << flowFields.memoryBytes() / 1024 << " KB" << endl;
+}
+
+// exit distance field: full build, O(1) direction hints, and repairs after wall edits
+void benchExitField(Bench& bench, BenchMaze& maze, const Queries& queries)
+{
+    MazeGrid& grid = maze.grid;
+    size_t queryCount = queries.xs.size();
+
+    auto start = chrono::steady_clock::now();
+    grid.buildExitField();
+    double fieldSeconds = secondsSince(start);
+    size_t fieldBytes = grid.getExitField().memoryBytes();
+    record(bench, maze, "buildExitField", maze.cells, fieldSeconds, "cells/s", fieldBytes);
+
+    start = chrono::steady_clock::now();
+    for (size_t q = 0; q < queryCount; q++) {
+        WallGrid::Direction direction;
+        bench.hints += grid.exitDirection(queries.xs[q], queries.zs[q], direction) ? direction : 0;
+    }
+    double hintSeconds = secondsSince(start);
+    record(bench, maze, "exitDirection", queryCount, hintSeconds, "queries/s", fieldBytes);
+
+    // Open a wall and close it again, so the maze ends up as generated; a maze one cell wide
+    // has no inner east wall to toggle
+    if (maze.size < 2) {
+        return;
+    }
+    size_t toggleCount = min(queryCount, size_t(1000));
+    size_t repairedCells = 0;
+    start = chrono::steady_clock::now();
+    for (size_t q = 0; q < toggleCount; q++) {
+        int x = min(static_cast<int>(queries.xs[q]), maze.size - 2);
+        int y = min(static_cast<int>(queries.zs[q]), maze.size - 1);
+        bool present = grid.getWalls().hasWall(x, y, WallGrid::EAST);
+        grid.setWall(x, y, WallGrid::EAST, !present);
+        repairedCells += grid.getExitField().getUpdatedCount();
+        grid.setWall(x, y, WallGrid::EAST, present);
+        repairedCells += grid.getExitField().getUpdatedCount();
+    }
+    double toggleSeconds = secondsSince(start);
+    record(bench, maze, "exitFieldRepair", toggleCount * 2, toggleSeconds, "edits/s",
+           grid.getExitField().memoryBytes()).gridHash = grid.getWalls().hash();
+    if (toggleCount > 0) {
+        cerr << "maze_bench:   exit field repair touched " << repairedCells / (toggleCount * 2)
+             << " cells per edit on average, full build " << fieldSeconds * 1e3 << " ms" << endl;
+    }
+}
+
+// point tests, swept moves one by one and batched, and the batch overlap kernels
+void benchCollision(Bench& bench, BenchMaze& maze, const Queries& queries)
+{
+    MazeGrid& grid = maze.grid;
+    const vector<float>& xs = queries.xs;
+    const vector<float>& zs = queries.zs;
+    size_t queryCount = xs.size();
+
+    auto start = chrono::steady_clock::now();
+    for (size_t q = 0; q < queryCount; q++) {
+        bench.collisions += grid.checkCollision(xs[q], zs[q]);
+    }
+    double collisionSeconds = secondsSince(start);
+    record(bench, maze, "checkCollision", queryCount, collisionSeconds, "queries/s", maze.scratchBytes);
+
+    // Swept moves of up to a quarter cell per axis and random radii, drawn before timing
+    mt19937 moveRng(querySeed(maze.seed));
+    uniform_real_distribution<float> delta(-0.25f, 0.25f);
+    uniform_real_distribution<float> bodyRadii(0.05f, 0.3f);
+    vector<float> moveXs(queryCount);
+    vector<float> moveZs(queryCount);
+    vector<float> radii(queryCount);
+    for (size_t q = 0; q < queryCount; q++) {
+        moveXs[q] = delta(moveRng);
+        moveZs[q] = delta(moveRng);
+        radii[q] = bodyRadii(moveRng);
+    }
+
+    vector<float> bodyXs(xs);
+    vector<float> bodyZs(zs);
+    start = chrono::steady_clock::now();
+    for (size_t q = 0; q < queryCount; q++) {
+        bench.collisions += grid.moveCircle(bodyXs[q], bodyZs[q], moveXs[q], moveZs[q], bodyRadius);
+    }
+    double moveSeconds = secondsSince(start);
+    record(bench, maze, "moveCircle", queryCount, moveSeconds, "queries/s", maze.scratchBytes);
+
+    bodyXs = xs;
+    bodyZs = zs;
+    start = chrono::steady_clock::now();
+    bench.collisions += grid.moveCircles(bodyXs.data(), bodyZs.data(), moveXs.data(), moveZs.data(), bodyRadius,
+                                         queryCount);
+    double batchMoveSeconds = secondsSince(start);
+    record(bench, maze, "moveCircles", queryCount, batchMoveSeconds, "queries/s", bodyXs.capacity() * sizeof(float) * 2);
+
+    // Batch overlap checks on the SIMD kernel and on the scalar one, repeated so short batches
+    // still take measurable time
+    vector<uint8_t> hitBits((queryCount + 7) / 8);
+    size_t batchRepeats = max(size_t(1), size_t(20000000) / max(queryCount, size_t(1)));
+    size_t batchBytes = (bodyXs.capacity() * 2 + radii.capacity()) * sizeof(float) + hitBits.capacity();
+    double kernelSeconds[2];
+    CollisionBatch::Kernel kernels[2] = { CollisionBatch::AUTO, CollisionBatch::SCALAR };
+    for (int k = 0; k < 2; k++) {
+        start = chrono::steady_clock::now();
+        for (size_t repeat = 0; repeat < batchRepeats; repeat++) {
+            bench.collisions += CollisionBatch::resolve(grid.getWalls(), 0.0f, 0.0f, 1.0f, xs.data(), zs.data(),
+                                                        radii.data(), queryCount, bodyXs.data(), bodyZs.data(),
+                                                        hitBits.data(), kernels[k]);
+        }
+        kernelSeconds[k] = secondsSince(start);
+        record(bench, maze, k == 0 ? "resolveCircles" : "resolveCirclesScalar", queryCount * batchRepeats,
+               kernelSeconds[k], "queries/s", batchBytes);
+    }
+
+    if (queryCount > 0) {
+        double checks = static_cast<double>(queryCount * batchRepeats);
+        cerr << "maze_bench:   batch collision " << CollisionBatch::kernelName(CollisionBatch::AUTO) << " "
+             << checks / kernelSeconds[0] / 1e6 << " M checks/s, scalar "
+             << checks / kernelSeconds[1] / 1e6 << " M checks/s" << endl;
+        cerr << "maze_bench:   swept circle " << moveSeconds * 1e9 / queryCount << " ns/query, batched "
+             << batchMoveSeconds * 1e9 / queryCount << " ns/query, point test "
+             << collisionSeconds * 1e9 / queryCount << " ns/query" << endl;
+    }
+}
+
+// streaming Eller generation straight to disk, O(width) memory; false when the file cannot be written
+bool benchStream(Bench& bench)
+{
+    const Options& options = bench.options;
+    uint64_t seed = options.seeds.front();
+    cerr << "maze_bench: streaming " << options.streamWidth << "x" << options.streamHeight << " to "
+         << options.streamFile << endl;
+    MazeStreamWriter writer;
+    if (!writer.write(options.streamFile, options.streamWidth, options.streamHeight, seed, options.rngKind)) {
+        return false;
+    }
+    remove(options.streamFile.c_str());
+    bench.results.push_back({ "streamEller", options.streamWidth, options.streamHeight, seed,
+                              options.rngName, "eller", 1,
+                              MazeGrid::mazeId(seed, options.streamWidth, options.streamHeight, options.rngKind,
+                                               MazeGenerator::ELLER),
+                              writer.getHash(), writer.getRowsWritten(), writer.getSeconds(), "rows/s",
+                              writer.getBytesWritten(), writer.getScratchBytes(), peakRssKB() });
+    return true;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    Bench bench;
+    if (argc == 2 && string(argv[1]) == "--help") {
+        printUsage(cout);
+        return 0;
+    }
+    if (!parseOptions(argc, argv, bench.options)) {
+        return 1;
+    }
+    const Options& options = bench.options;
+
+    for (int size : options.sizes) {
+        for (uint64_t seed : options.seeds) {
+            Queries queries;
+            makeQueries(size, seed, options.queryCount, queries);
+
+            for (MazeGenerator::Algorithm algorithm : options.algorithms) {
+                BenchMaze maze = { MazeGrid(size, size, seed, options.rngKind), size,
+                                   static_cast<size_t>(size) * size, seed, algorithm,
+                                   MazeGenerator::getName(algorithm), 0, 0, 0, 0, 0.0 };
+                cerr << "maze_bench: " << size << "x" << size << " seed " << seed << " " << maze.algorithmName << endl;
+
+                benchGeneration(bench, maze);
+                if (!options.mazeFile.empty() && !benchMazeFile(bench, maze)) {
+                    return 1;
+                }
+                benchTiled(bench, maze);
+                if (!benchPaths(bench, maze, queries)) {
+                    return 1;
+                }
+                benchAgents(bench, maze);
+                benchFlowFields(bench, maze, queries);
+                benchExitField(bench, maze, queries);
+                benchCollision(bench, maze, queries);
+            }
+        }
+    }
+
+    if (options.streamWidth > 0 && !options.seeds.empty() && !benchStream(bench)) {
+        return 1;
+    }
+
+    if (options.format == "csv")
+        printCsv(bench.results);
+    else
+        printJson(bench.results);
+
+    cerr << "maze_bench: " << bench.collisions << " colliding queries, " << bench.hints << " hint sum" << endl;
+    return 0;
+}
@@ -0,0 +1,68 @@
+#include "CameraPath.h"
+
+#include <algorithm>
+#include <cmath>
+
+CameraPath::CameraPath()
+{
+}
+
+// append a waypoint to the route
+void CameraPath::addWaypoint(const glm::vec3& point)
+{
+    float length = points.empty() ? 0.0f : cumulative.back() + glm::length(point - points.back());
+    points.push_back(point);
+    cumulative.push_back(length);
+}
+
+void CameraPath::clear()
+{
+    points.clear();
+    cumulative.clear();
+}
+
+size_t CameraPath::getWaypointCount() const
+{
+    return points.size();
+}
+
+// length of the route from the first to the last waypoint
+float CameraPath::getLength() const
+{
+    return cumulative.empty() ? 0.0f : cumulative.back();
+}
+
+// position and heading at the given distance along the route
+void CameraPath::sample(float distance, glm::vec3& position, float& yaw) const
+{
+    if (points.empty()) {
+        position = glm::vec3(0.0f);
+        yaw = -90.0f;
+        return;
+    }
+    float length = getLength();
+    if (points.size() == 1 || length <= 0.0f) {
+        position = points.front();
+        yaw = -90.0f;
+        return;
+    }
+
+    // Ping-pong between the ends of the route
+    float d = fmod(max(distance, 0.0f), 2.0f * length);
+    bool backwards = d > length;
+    if (backwards) {
+        d = 2.0f * length - d;
+    }
+
+    // Segment containing d
+    size_t segment = upper_bound(cumulative.begin(), cumulative.end(), d) - cumulative.begin();
+    segment = min(max(segment, size_t(1)), points.size() - 1);
+    const glm::vec3& from = points[segment - 1];
+    const glm::vec3& to = points[segment];
+    float segmentLength = cumulative[segment] - cumulative[segment - 1];
+    float t = segmentLength > 0.0f ? (d - cumulative[segment - 1]) / segmentLength : 0.0f;
+    position = from + (to - from) * t;
+
+    glm::vec3 direction = backwards ? from - to : to - from;
+    yaw = glm::degrees(atan2(direction.z, direction.x));
+}
@@ -0,0 +1,40 @@
+#ifndef CAMERAPATH_H
+#define CAMERAPATH_H
+
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <vector>
+
+using namespace std;
+
+// Scripted camera route for repeatable benchmark runs.
+// Waypoints are joined by straight segments and sampled by distance along
+// the route; past the last waypoint the camera walks back to the first, so
+// any number of frames can be sampled from a short route.
+class CameraPath
+{
+public:
+    CameraPath();
+
+    // append a waypoint to the route
+    void addWaypoint(const glm::vec3& point);
+
+    void clear();
+
+    size_t getWaypointCount() const;
+
+    // length of the route from the first to the last waypoint
+    float getLength() const;
+
+    // position and heading at the given distance along the route
+    // yaw is in degrees and uses the Camera convention (0 looks along +x, 90 along +z)
+    void sample(float distance, glm::vec3& position, float& yaw) const;
+
+private:
+    vector<glm::vec3> points;
+    vector<float> cumulative;   // route length up to each waypoint
+};
+
+#endif
@@ -0,0 +1,447 @@
+#include "ChunkGraph.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+
+namespace {
+
+// Neighbour offsets and the direction leading back, in WallGrid order (N, S, W, E)
+const int dx[4] = { 0, 0, -1, 1 };
+const int dy[4] = { -1, 1, 0, 0 };
+const uint8_t back[4] = { WallGrid::SOUTH, WallGrid::NORTH, WallGrid::EAST, WallGrid::WEST };
+
+const uint32_t noNode = 0xffffffffu;
+const uint32_t unreachable = 0xffffffffu;
+
+// local cell flags while a chunk is reduced; the low four bits are the open walls inside the chunk
+const uint8_t entranceFlag = 0x10;
+const uint8_t prunedFlag = 0x20;
+
+}
+
+ChunkGraph::ChunkGraph()
+    : width(0), height(0), chunkSize(0), chunksX(0), searchStamp(0), localSearch(0), expandedCount(0), searchedCells(0)
+{
+}
+
+// build the abstract graph of the walls
+void ChunkGraph::build(const WallGrid& walls, int chunkSize)
+{
+    clear();
+    if (walls.getWidth() <= 0 || walls.getHeight() <= 0) {
+        return;
+    }
+    width = walls.getWidth();
+    height = walls.getHeight();
+    this->chunkSize = max(chunkSize, 4);
+    chunksX = (width + this->chunkSize - 1) / this->chunkSize;
+    int chunksY = (height + this->chunkSize - 1) / this->chunkSize;
+    int chunkCount = chunksX * chunksY;
+
+    size_t localCells = static_cast<size_t>(this->chunkSize) * this->chunkSize;
+    localStamp.assign(localCells, 0);
+    localDistance.resize(localCells);
+    localParent.resize(localCells);
+    localQueue.resize(localCells);
+    localSearch = 0;
+
+    // Nodes and the edges inside each chunk, then the unit edges across the chunk borders
+    vector<uint32_t> edgeFrom;
+    vector<Edge> edgeList;
+    chunkNodes.reserve(chunkCount + 1);
+    for (int chunk = 0; chunk < chunkCount; chunk++) {
+        chunkNodes.push_back(static_cast<uint32_t>(nodeCells.size()));
+        buildChunk(walls, chunk, edgeFrom, edgeList);
+    }
+    chunkNodes.push_back(static_cast<uint32_t>(nodeCells.size()));
+
+    for (uint32_t node = 0; node < nodeCells.size(); node++) {
+        int x = static_cast<int>(nodeCells[node] % width);
+        int y = static_cast<int>(nodeCells[node] / width);
+        int chunk = chunkOf(x, y);
+        for (int dir = 0; dir < 4; dir++) {
+            int nx = x + dx[dir];
+            int ny = y + dy[dir];
+            if (nx < 0 || nx >= width || ny < 0 || ny >= height || chunkOf(nx, ny) == chunk ||
+                walls.hasWall(x, y, static_cast<WallGrid::Direction>(dir))) {
+                continue;
+            }
+            edgeFrom.push_back(node);
+            edgeList.push_back({ findNode(chunkOf(nx, ny), static_cast<uint32_t>(ny) * width + nx), 1 });
+        }
+    }
+
+    // Edges grouped by their source node
+    size_t nodeCount = nodeCells.size();
+    edgeStart.assign(nodeCount + 1, 0);
+    for (uint32_t from : edgeFrom) {
+        edgeStart[from + 1]++;
+    }
+    for (size_t node = 0; node < nodeCount; node++) {
+        edgeStart[node + 1] += edgeStart[node];
+    }
+    edges.resize(edgeList.size());
+    vector<uint32_t> next(edgeStart.begin(), edgeStart.end() - 1);
+    for (size_t i = 0; i < edgeList.size(); i++) {
+        edges[next[edgeFrom[i]]++] = edgeList[i];
+    }
+
+    nodeStamp.assign(nodeCount, 0);
+    nodeDistance.resize(nodeCount);
+    nodeParent.resize(nodeCount);
+    searchStamp = 0;
+
+    // The chunk reduction left node ids in the stamps
+    fill(localStamp.begin(), localStamp.end(), 0);
+}
+
+// drop the graph
+void ChunkGraph::clear()
+{
+    width = 0;
+    height = 0;
+    chunkSize = 0;
+    chunksX = 0;
+    nodeCells.clear();
+    chunkNodes.clear();
+    edgeStart.clear();
+    edges.clear();
+    nodeStamp.clear();
+    nodeDistance.clear();
+    nodeParent.clear();
+}
+
+void ChunkGraph::chunkBounds(int chunk, int& x0, int& y0, int& x1, int& y1) const
+{
+    x0 = (chunk % chunksX) * chunkSize;
+    y0 = (chunk / chunksX) * chunkSize;
+    x1 = min(x0 + chunkSize, width);
+    y1 = min(y0 + chunkSize, height);
+}
+
+// node of an entrance cell in the given chunk; nodes of a chunk are sorted by cell
+uint32_t ChunkGraph::findNode(int chunk, uint32_t cell) const
+{
+    auto first = nodeCells.begin() + chunkNodes[chunk];
+    auto last = nodeCells.begin() + chunkNodes[chunk + 1];
+    return static_cast<uint32_t>(lower_bound(first, last, cell) - nodeCells.begin());
+}
+
+// reduce one chunk to its entrances and junctions joined by corridor edges
+void ChunkGraph::buildChunk(const WallGrid& walls, int chunk, vector<uint32_t>& edgeFrom, vector<Edge>& edgeList)
+{
+    int x0, y0, x1, y1;
+    chunkBounds(chunk, x0, y0, x1, y1);
+
+    // The local scratch of the searches doubles as flags, neighbour counts and node ids here
+    vector<uint8_t>& flags = localParent;
+    vector<uint32_t>& degree = localDistance;
+    vector<uint32_t>& localNode = localStamp;
+    vector<uint32_t>& pending = localQueue;
+    size_t pendingCount = 0;
+
+    auto local = [&](int x, int y) { return static_cast<size_t>(y - y0) * chunkSize + (x - x0); };
+
+    for (int y = y0; y < y1; y++) {
+        for (int x = x0; x < x1; x++) {
+            uint8_t cellFlags = 0;
+            for (int dir = 0; dir < 4; dir++) {
+                int nx = x + dx[dir];
+                int ny = y + dy[dir];
+                if (nx < 0 || nx >= width || ny < 0 || ny >= height ||
+                    walls.hasWall(x, y, static_cast<WallGrid::Direction>(dir))) {
+                    continue;
+                }
+                if (nx >= x0 && nx < x1 && ny >= y0 && ny < y1)
+                    cellFlags |= 1u << dir;
+                else
+                    cellFlags |= entranceFlag;
+            }
+            size_t cell = local(x, y);
+            flags[cell] = cellFlags;
+            degree[cell] = __builtin_popcount(cellFlags & 15u);
+            localNode[cell] = noNode;
+            if (degree[cell] <= 1 && !(cellFlags & entranceFlag)) {
+                pending[pendingCount++] = static_cast<uint32_t>(cell);
+            }
+        }
+    }
+
+    // Prune dead ends: no shortest path between two entrances enters one
+    while (pendingCount > 0) {
+        uint32_t cell = pending[--pendingCount];
+        if (flags[cell] & prunedFlag) {
+            continue;
+        }
+        flags[cell] |= prunedFlag;
+        int x = x0 + static_cast<int>(cell % chunkSize);
+        int y = y0 + static_cast<int>(cell / chunkSize);
+        for (int dir = 0; dir < 4; dir++) {
+            if (!(flags[cell] >> dir & 1u)) {
+                continue;
+            }
+            size_t neighbour = local(x + dx[dir], y + dy[dir]);
+            if (flags[neighbour] & prunedFlag) {
+                continue;
+            }
+            // Each cell is queued once: at the start, or when its count drops to one
+            if (--degree[neighbour] == 1 && !(flags[neighbour] & entranceFlag)) {
+                pending[pendingCount++] = static_cast<uint32_t>(neighbour);
+            }
+        }
+    }
+
+    // Entrances and junctions become nodes, in cell order
+    for (int y = y0; y < y1; y++) {
+        for (int x = x0; x < x1; x++) {
+            size_t cell = local(x, y);
+            if (!(flags[cell] & prunedFlag) && ((flags[cell] & entranceFlag) || degree[cell] != 2)) {
+                localNode[cell] = static_cast<uint32_t>(nodeCells.size());
+                nodeCells.push_back(static_cast<uint32_t>(y) * width + x);
+            }
+        }
+    }
+
+    // Follow each corridor out of every node to the node at its other end
+    for (uint32_t node = chunkNodes[chunk]; node < nodeCells.size(); node++) {
+        int nodeX = static_cast<int>(nodeCells[node] % width);
+        int nodeY = static_cast<int>(nodeCells[node] / width);
+        for (int dir = 0; dir < 4; dir++) {
+            if (!(flags[local(nodeX, nodeY)] >> dir & 1u)) {
+                continue;
+            }
+            int previousX = nodeX;
+            int previousY = nodeY;
+            int x = nodeX + dx[dir];
+            int y = nodeY + dy[dir];
+            if (flags[local(x, y)] & prunedFlag) {
+                continue;
+            }
+            uint32_t length = 1;
+            while (localNode[local(x, y)] == noNode) {
+                // A corridor cell has exactly one unpruned neighbour besides the one we came from
+                uint8_t cellFlags = flags[local(x, y)];
+                for (int step = 0; step < 4; step++) {
+                    int nx = x + dx[step];
+                    int ny = y + dy[step];
+                    if ((cellFlags >> step & 1u) && (nx != previousX || ny != previousY) &&
+                        !(flags[local(nx, ny)] & prunedFlag)) {
+                        previousX = x;
+                        previousY = y;
+                        x = nx;
+                        y = ny;
+                        break;
+                    }
+                }
+                length++;
+            }
+            uint32_t target = localNode[local(x, y)];
+            if (target != node) {
+                edgeFrom.push_back(node);
+                edgeList.push_back({ target, length });
+            }
+        }
+    }
+}
+
+// breadth-first search inside a chunk from (x, y)
+void ChunkGraph::searchChunk(const WallGrid& walls, int chunk, int x, int y, int targetX, int targetY)
+{
+    if (++localSearch == 0) {
+        fill(localStamp.begin(), localStamp.end(), 0);
+        localSearch = 1;
+    }
+    int x0, y0, x1, y1;
+    chunkBounds(chunk, x0, y0, x1, y1);
+
+    uint32_t first = static_cast<uint32_t>((y - y0) * chunkSize + (x - x0));
+    localStamp[first] = localSearch;
+    localDistance[first] = 0;
+    localQueue[0] = first;
+    size_t head = 0;
+    size_t tail = 1;
+    while (head < tail) {
+        uint32_t cell = localQueue[head++];
+        int cellX = x0 + static_cast<int>(cell % chunkSize);
+        int cellY = y0 + static_cast<int>(cell / chunkSize);
+        if (cellX == targetX && cellY == targetY) {
+            break;
+        }
+        for (int dir = 0; dir < 4; dir++) {
+            int nx = cellX + dx[dir];
+            int ny = cellY + dy[dir];
+            if (nx < x0 || nx >= x1 || ny < y0 || ny >= y1 ||
+                walls.hasWall(cellX, cellY, static_cast<WallGrid::Direction>(dir))) {
+                continue;
+            }
+            uint32_t neighbour = static_cast<uint32_t>((ny - y0) * chunkSize + (nx - x0));
+            if (localStamp[neighbour] == localSearch) {
+                continue;
+            }
+            localStamp[neighbour] = localSearch;
+            localDistance[neighbour] = localDistance[cell] + 1;
+            localParent[neighbour] = back[dir];
+            localQueue[tail++] = neighbour;
+        }
+    }
+    searchedCells += tail;
+}
+
+// append the cells after (x, y) up to (targetX, targetY), both in the same chunk
+void ChunkGraph::refine(const WallGrid& walls, int x, int y, int targetX, int targetY, vector<pair<int, int>>& path)
+{
+    int chunk = chunkOf(x, y);
+    searchChunk(walls, chunk, x, y, targetX, targetY);
+    int x0, y0, x1, y1;
+    chunkBounds(chunk, x0, y0, x1, y1);
+
+    // Collected from the target back and turned around
+    size_t turn = path.size();
+    int cellX = targetX;
+    int cellY = targetY;
+    while (cellX != x || cellY != y) {
+        path.push_back({ cellX, cellY });
+        uint8_t direction = localParent[(cellY - y0) * chunkSize + (cellX - x0)];
+        cellX += dx[direction];
+        cellY += dy[direction];
+    }
+    reverse(path.begin() + turn, path.end());
+}
+
+// shortest path between two cells: A* over the abstract graph, refined chunk by chunk
+bool ChunkGraph::findPath(const WallGrid& walls, int startX, int startY, int endX, int endY,
+                          vector<pair<int, int>>& path)
+{
+    path.clear();
+    expandedCount = 0;
+    searchedCells = 0;
+    if (!isBuilt() || walls.getWidth() != width || walls.getHeight() != height ||
+        startX < 0 || startX >= width || startY < 0 || startY >= height ||
+        endX < 0 || endX >= width || endY < 0 || endY >= height) {
+        return false;
+    }
+    if (++searchStamp == 0) {
+        fill(nodeStamp.begin(), nodeStamp.end(), 0);
+        searchStamp = 1;
+    }
+
+    int startChunk = chunkOf(startX, startY);
+    int goalChunk = chunkOf(endX, endY);
+    auto localOf = [&](uint32_t cell) {
+        int x = static_cast<int>(cell % width);
+        int y = static_cast<int>(cell / width);
+        return static_cast<size_t>(y % chunkSize) * chunkSize + (x % chunkSize);
+    };
+    auto estimate = [&](uint32_t node) {
+        int x = static_cast<int>(nodeCells[node] % width);
+        int y = static_cast<int>(nodeCells[node] / width);
+        return static_cast<uint32_t>(abs(x - endX) + abs(y - endY));
+    };
+
+    // Distance from the goal chunk's nodes to the goal, and the direct route inside one chunk
+    uint32_t best = unreachable;
+    uint32_t bestNode = noNode;
+    searchChunk(walls, goalChunk, endX, endY, -1, -1);
+    uint32_t goalFirst = chunkNodes[goalChunk];
+    uint32_t goalCount = chunkNodes[goalChunk + 1] - goalFirst;
+    goalDistance.assign(goalCount, unreachable);
+    for (uint32_t i = 0; i < goalCount; i++) {
+        size_t cell = localOf(nodeCells[goalFirst + i]);
+        if (localStamp[cell] == localSearch)
+            goalDistance[i] = localDistance[cell];
+    }
+    if (startChunk == goalChunk) {
+        size_t cell = localOf(static_cast<uint32_t>(startY) * width + startX);
+        if (localStamp[cell] == localSearch)
+            best = localDistance[cell];
+    }
+
+    // The start chunk's nodes are the first open nodes (a chunk without entrances has none)
+    heap.clear();
+    if (chunkNodes[startChunk + 1] > chunkNodes[startChunk]) {
+        searchChunk(walls, startChunk, startX, startY, -1, -1);
+    }
+    for (uint32_t node = chunkNodes[startChunk]; node < chunkNodes[startChunk + 1]; node++) {
+        size_t cell = localOf(nodeCells[node]);
+        if (localStamp[cell] != localSearch) {
+            continue;
+        }
+        nodeStamp[node] = searchStamp;
+        nodeDistance[node] = localDistance[cell];
+        nodeParent[node] = noNode;
+        heap.push_back(uint64_t(localDistance[cell] + estimate(node)) << 32 | node);
+    }
+    make_heap(heap.begin(), heap.end(), greater<uint64_t>());
+
+    // A* with the Manhattan distance, which never overestimates in a grid
+    while (!heap.empty()) {
+        pop_heap(heap.begin(), heap.end(), greater<uint64_t>());
+        uint64_t top = heap.back();
+        heap.pop_back();
+        uint32_t bound = static_cast<uint32_t>(top >> 32);
+        uint32_t node = static_cast<uint32_t>(top);
+        if (bound >= best) {
+            break;
+        }
+        uint32_t distance = nodeDistance[node];
+        if (distance + estimate(node) != bound) {
+            continue;   // a shorter way to this node was found after it was queued
+        }
+        expandedCount++;
+
+        if (node - goalFirst < goalCount && goalDistance[node - goalFirst] != unreachable &&
+            distance + goalDistance[node - goalFirst] < best) {
+            best = distance + goalDistance[node - goalFirst];
+            bestNode = node;
+        }
+
+        for (uint32_t i = edgeStart[node]; i < edgeStart[node + 1]; i++) {
+            uint32_t target = edges[i].target;
+            uint32_t targetDistance = distance + edges[i].length;
+            if (nodeStamp[target] == searchStamp && nodeDistance[target] <= targetDistance) {
+                continue;
+            }
+            nodeStamp[target] = searchStamp;
+            nodeDistance[target] = targetDistance;
+            nodeParent[target] = node;
+            heap.push_back(uint64_t(targetDistance + estimate(target)) << 32 | target);
+            push_heap(heap.begin(), heap.end(), greater<uint64_t>());
+        }
+    }
+
+    if (best == unreachable) {
+        return false;
+    }
+
+    // Refine: a search inside the chunk between consecutive route nodes, a single step between chunks
+    path.reserve(best + 1);
+    path.push_back({ startX, startY });
+    route.clear();
+    for (uint32_t node = bestNode; node != noNode; node = nodeParent[node]) {
+        route.push_back(node);
+    }
+    int x = startX;
+    int y = startY;
+    for (auto it = route.rbegin(); it != route.rend(); ++it) {
+        int nodeX = static_cast<int>(nodeCells[*it] % width);
+        int nodeY = static_cast<int>(nodeCells[*it] / width);
+        if (chunkOf(nodeX, nodeY) == chunkOf(x, y))
+            refine(walls, x, y, nodeX, nodeY, path);
+        else
+            path.push_back({ nodeX, nodeY });
+        x = nodeX;
+        y = nodeY;
+    }
+    refine(walls, x, y, endX, endY, path);
+    return true;
+}
+
+// bytes used by the graph and the query scratch
+size_t ChunkGraph::memoryBytes() const
+{
+    return (nodeCells.capacity() + chunkNodes.capacity() + edgeStart.capacity() + nodeStamp.capacity() +
+            nodeDistance.capacity() + nodeParent.capacity() + goalDistance.capacity() + route.capacity() +
+            localStamp.capacity() + localDistance.capacity() + localQueue.capacity()) * sizeof(uint32_t) +
+           edges.capacity() * sizeof(Edge) + heap.capacity() * sizeof(uint64_t) + localParent.capacity();
+}
@@ -0,0 +1,105 @@
+#ifndef CHUNKGRAPH_H
+#define CHUNKGRAPH_H
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "WallGrid.h"
+
+using namespace std;
+
+// Hierarchical path finding (HPA*) for mazes too large to search cell by cell.
+// The grid is cut into square chunks. Every cell with an open wall across a chunk border is an
+// entrance; inside each chunk the cells are reduced to an abstract graph that keeps the exact
+// walking distances between its entrances: dead ends are pruned, and runs of corridor cells are
+// contracted into one weighted edge between the entrances and junctions at their ends. Open
+// border walls join the entrances of neighbouring chunks with unit edges.
+// A query searches the start and goal chunks cell by cell to reach their entrances, runs A*
+// over the abstract graph, and then refines the route by searching only inside the chunks it
+// passes through, so paths are as short as a full search finds. Works on any maze, also one
+// with loops; a maze tiled by TiledGenerator with the same chunk size has one door per tile pair
+// and the smallest graph.
+// Cells are numbered y * width + x, as elsewhere.
+class ChunkGraph
+{
+public:
+    ChunkGraph();
+
+    // build the abstract graph of the walls with chunks of chunkSize x chunkSize cells (at least 4)
+    void build(const WallGrid& walls, int chunkSize);
+
+    // drop the graph (e.g. after a new maze was generated or a wall changed)
+    void clear();
+    bool isBuilt() const { return width > 0; }
+
+    // shortest path between two cells through open walls, from start to end (both included), like
+    // PathSolver::findPath; walls must be the grid the graph was built from
+    bool findPath(const WallGrid& walls, int startX, int startY, int endX, int endY, vector<pair<int, int>>& path);
+
+    int getChunkSize() const { return chunkSize; }
+    size_t getNodeCount() const { return nodeCells.size(); }
+    size_t getEdgeCount() const { return edges.size(); }
+
+    // abstract nodes A* expanded and cells searched inside chunks by the last query
+    size_t getExpandedCount() const { return expandedCount; }
+    size_t getSearchedCells() const { return searchedCells; }
+
+    // bytes used by the graph and the query scratch
+    size_t memoryBytes() const;
+
+private:
+    struct Edge {
+        uint32_t target;
+        uint32_t length;
+    };
+
+    int width;
+    int height;
+    int chunkSize;
+    int chunksX;
+
+    // abstract graph: node cells grouped by chunk (ascending within a chunk), edges in CSR form
+    vector<uint32_t> nodeCells;
+    vector<uint32_t> chunkNodes;    // first node of each chunk, plus the node count at the end
+    vector<uint32_t> edgeStart;     // first edge of each node, plus the edge count at the end
+    vector<Edge> edges;
+
+    // A* scratch per node, valid where nodeStamp equals the current search
+    vector<uint32_t> nodeStamp;
+    vector<uint32_t> nodeDistance;
+    vector<uint32_t> nodeParent;
+    vector<uint64_t> heap;          // (estimate << 32 | node), a min-heap
+    vector<uint32_t> goalDistance;  // from each goal chunk node to the goal cell
+    vector<uint32_t> route;
+    uint32_t searchStamp;
+
+    // search scratch inside one chunk, by local cell index, valid where localStamp equals localSearch
+    vector<uint32_t> localStamp;
+    vector<uint32_t> localDistance;
+    vector<uint8_t> localParent;    // direction back to the parent cell (WallGrid::Direction)
+    vector<uint32_t> localQueue;
+    uint32_t localSearch;
+
+    size_t expandedCount;
+    size_t searchedCells;
+
+    int chunkOf(int x, int y) const { return (y / chunkSize) * chunksX + x / chunkSize; }
+    void chunkBounds(int chunk, int& x0, int& y0, int& x1, int& y1) const;
+
+    // node of an entrance cell in the given chunk
+    uint32_t findNode(int chunk, uint32_t cell) const;
+
+    void buildChunk(const WallGrid& walls, int chunk, vector<uint32_t>& edgeFrom, vector<Edge>& edgeList);
+
+    // breadth-first search inside a chunk from (x, y), stops early once (targetX, targetY) is reached
+    void searchChunk(const WallGrid& walls, int chunk, int x, int y, int targetX, int targetY);
+
+    // append the cells after (x, y) up to (targetX, targetY) on the path inside their chunk
+    void refine(const WallGrid& walls, int x, int y, int targetX, int targetY, vector<pair<int, int>>& path);
+};
+
+#endif
@@ -0,0 +1,235 @@
+#include "CircleCollider.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// wall segment on a grid line: z = line for x in [from, to], or x = line for z in [from, to]
+struct Segment {
+    float from;
+    float to;
+    float line;
+    bool horizontal;
+};
+
+// gap kept between the circle and a wall after a contact, in cells
+const float skin = 1e-4f;
+
+// largest clearance, so a half-cell step cannot reach past the 3x3 neighbourhood
+const float maxRadius = 0.49f;
+
+// walls within reach of (x, z), the square of half-size reach around it, each shared wall once;
+// the outer boundary always counts. With reach under one cell these are walls of the 3x3 cells
+// around (x, z), at most two lines per axis. Returns the number of segments written (at most 12)
+int gatherWalls(const WallGrid& walls, float x, float z, float reach, Segment* segments)
+{
+    int width = walls.getWidth();
+    int height = walls.getHeight();
+    int firstColumn = max(static_cast<int>(ceil(x - reach)), 0);
+    int lastColumn = min(static_cast<int>(floor(x + reach)), width);
+    int firstRow = max(static_cast<int>(ceil(z - reach)), 0);
+    int lastRow = min(static_cast<int>(floor(z + reach)), height);
+    int firstX = max(static_cast<int>(floor(x - reach)), 0);
+    int lastX = min(static_cast<int>(floor(x + reach)), width - 1);
+    int firstY = max(static_cast<int>(floor(z - reach)), 0);
+    int lastY = min(static_cast<int>(floor(z + reach)), height - 1);
+    int count = 0;
+
+    // Horizontal lines z = row
+    for (int row = firstRow; row <= lastRow; row++) {
+        for (int cellX = firstX; cellX <= lastX; cellX++) {
+            if (row == 0 || row == height || walls.hasWall(cellX, row, WallGrid::NORTH)) {
+                segments[count++] = { float(cellX), float(cellX + 1), float(row), true };
+            }
+        }
+    }
+
+    // Vertical lines x = column
+    for (int column = firstColumn; column <= lastColumn; column++) {
+        for (int cellY = firstY; cellY <= lastY; cellY++) {
+            if (column == 0 || column == width || walls.hasWall(column, cellY, WallGrid::WEST)) {
+                segments[count++] = { float(cellY), float(cellY + 1), float(column), false };
+            }
+        }
+    }
+    return count;
+}
+
+// earliest time t in [0, best) at which the point (px, pz) + t (dx, dz) comes within radius of
+// the segment; updates best and the contact normal (nx, nz) and returns true when there is one
+bool sweep(const Segment& segment, float px, float pz, float dx, float dz, float radius,
+           float& best, float& nx, float& nz)
+{
+    // Work as if the segment were horizontal, swapping the axes of vertical ones
+    float u = segment.horizontal ? px : pz;
+    float v = segment.horizontal ? pz : px;
+    float du = segment.horizontal ? dx : dz;
+    float dv = segment.horizontal ? dz : dx;
+
+    // Most walls of the neighbourhood are out of reach of a short move: skip them on its bounds
+    if (min(v, v + dv) - radius > segment.line || max(v, v + dv) + radius < segment.line ||
+        min(u, u + du) - radius > segment.to || max(u, u + du) + radius < segment.from) {
+        return false;
+    }
+    bool hit = false;
+    float normalU = 0.0f;
+    float normalV = 0.0f;
+
+    // The flat side facing the point, when moving toward it
+    float side = v < segment.line ? -1.0f : 1.0f;
+    if (dv * side < 0.0f) {
+        // A point already inside the capsule (by rounding) is stopped where it is
+        float t = max((segment.line + side * radius - v) / dv, 0.0f);
+        float u0 = u + t * du;
+        if (t >= 0.0f && t < best && u0 >= segment.from && u0 <= segment.to) {
+            best = t;
+            normalU = 0.0f;
+            normalV = side;
+            hit = true;
+        }
+    }
+
+    // The rounded ends
+    float ends[2] = { segment.from, segment.to };
+    float a = du * du + dv * dv;
+    for (float end : ends) {
+        float mu = u - end;
+        float mv = v - segment.line;
+        float b = mu * du + mv * dv;
+        float c = mu * mu + mv * mv - radius * radius;
+        if (b >= 0.0f) {
+            continue;   // moving away
+        }
+        float discriminant = b * b - a * c;
+        if (discriminant < 0.0f) {
+            continue;
+        }
+        float t = max((-b - sqrt(discriminant)) / a, 0.0f);
+        if (t < best) {
+            float hitU = mu + t * du;
+            float hitV = mv + t * dv;
+            float distance = sqrt(hitU * hitU + hitV * hitV);
+            if (distance < 1e-6f) {
+                continue;
+            }
+            best = t;
+            normalU = hitU / distance;
+            normalV = hitV / distance;
+            hit = true;
+        }
+    }
+
+    if (hit) {
+        nx = segment.horizontal ? normalU : normalV;
+        nz = segment.horizontal ? normalV : normalU;
+    }
+    return hit;
+}
+
+// push the point out of every capsule it lies in, returns true when it had to move
+bool pushOut(const Segment* segments, int count, float& x, float& z, float radius)
+{
+    bool moved = false;
+    for (int i = 0; i < count; i++) {
+        const Segment& segment = segments[i];
+        float u = segment.horizontal ? x : z;
+        float v = segment.horizontal ? z : x;
+        float closest = min(max(u, segment.from), segment.to);
+        float du = u - closest;
+        float dv = v - segment.line;
+        float distanceSquared = du * du + dv * dv;
+        if (distanceSquared >= radius * radius) {
+            continue;
+        }
+
+        // Straight off the wall when on its center line
+        float distance = sqrt(distanceSquared);
+        float push = radius + skin - distance;
+        if (distance < 1e-6f) {
+            du = 0.0f;
+            dv = 1.0f;
+            distance = 1.0f;
+        }
+        u += du / distance * push;
+        v += dv / distance * push;
+        x = segment.horizontal ? u : v;
+        z = segment.horizontal ? v : u;
+        moved = true;
+    }
+    return moved;
+}
+
+}
+
+// move the circle at (x, z) by (moveX, moveZ), sliding along the walls it meets
+bool CircleCollider::move(const WallGrid& walls, float& x, float& z, float moveX, float moveZ, float radius)
+{
+    int width = walls.getWidth();
+    int height = walls.getHeight();
+    if (width <= 0 || height <= 0) {
+        x += moveX;
+        z += moveZ;
+        return false;
+    }
+    radius = min(radius, maxRadius);
+
+    // Clamped into the grid, so far off circles still find the boundary
+    x = min(max(x, 0.0f), float(width));
+    z = min(max(z, 0.0f), float(height));
+
+    // Steps of at most half a cell
+    float length = sqrt(moveX * moveX + moveZ * moveZ);
+    int steps = max(1, static_cast<int>(ceil(length / 0.5f)));
+    float stepX = moveX / steps;
+    float stepZ = moveZ / steps;
+    float stepLength = length / steps;
+
+    Segment segments[12];
+    int count = gatherWalls(walls, x, z, radius, segments);
+    bool touched = pushOut(segments, count, x, z, radius);
+    for (int step = 0; step < steps; step++) {
+        // Sliding keeps the circle within stepLength of where the step starts
+        count = gatherWalls(walls, x, z, stepLength + radius, segments);
+
+        // Up to three contacts per step: a corner can stop the slide along one wall at the next
+        float remainingX = stepX;
+        float remainingZ = stepZ;
+        for (int contact = 0; contact < 3; contact++) {
+            if (remainingX * remainingX + remainingZ * remainingZ < 1e-12f) {
+                break;
+            }
+            float t = 1.0f;
+            float nx = 0.0f;
+            float nz = 0.0f;
+            bool hit = false;
+            for (int i = 0; i < count; i++) {
+                hit |= sweep(segments[i], x, z, remainingX, remainingZ, radius, t, nx, nz);
+            }
+            if (!hit) {
+                x += remainingX;
+                z += remainingZ;
+                break;
+            }
+
+            // Stop at the contact and keep the part of the rest along the wall
+            touched = true;
+            x += remainingX * t + nx * skin;
+            z += remainingZ * t + nz * skin;
+            remainingX *= 1.0f - t;
+            remainingZ *= 1.0f - t;
+            float intoWall = remainingX * nx + remainingZ * nz;
+            if (intoWall < 0.0f) {
+                remainingX -= intoWall * nx;
+                remainingZ -= intoWall * nz;
+            }
+        }
+    }
+
+    // Rounding can leave the circle a hair inside a wall it slid along
+    if (touched) {
+        count = gatherWalls(walls, x, z, radius, segments);
+        pushOut(segments, count, x, z, radius);
+    }
+    return touched;
+}
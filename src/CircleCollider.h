@@ -0,0 +1,29 @@
+#ifndef CIRCLECOLLIDER_H
+#define CIRCLECOLLIDER_H
+
+#pragma once
+
+#include "WallGrid.h"
+
+using namespace std;
+
+// Swept collision of a moving circle against the maze walls, with sliding.
+// Walls are segments on the grid lines; a circle keeping radius clearance from them is a point
+// moving among capsules (the segments grown by radius). Each move is cut into steps of at most
+// half a cell, so only walls of the 3x3 cells around the circle can be reached in a step (only
+// those within reach of the step are tested) and nothing is skipped however fast the circle
+// moves. A step stops at the first capsule it hits, and the rest of the step slides along the
+// contact (its part along the normal is dropped).
+// The outer boundary of the grid always counts as a wall, also at the entrance and the exit.
+// Coordinates are in cell units relative to the maze origin (x = column, z = row).
+class CircleCollider
+{
+public:
+    // move the circle at (x, z) by (moveX, moveZ); radius is the clearance from the wall center lines
+    // (the body radius plus half the wall thickness) and is limited to just under half a cell.
+    // A circle that starts inside a wall is pushed out first, one outside the grid is brought back
+    // to its edge. Returns true when it touched a wall
+    static bool move(const WallGrid& walls, float& x, float& z, float moveX, float moveZ, float radius);
+};
+
+#endif
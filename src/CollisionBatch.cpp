@@ -0,0 +1,309 @@
+#include "CollisionBatch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define COLLISION_BATCH_X86 1
+#endif
+
+namespace {
+
+// gap kept between a pushed out circle and the wall, in cells (as in CircleCollider)
+const float skin = 1e-4f;
+
+// 1 / sqrt(2): a circle exactly on a grid point is pushed out diagonally
+const float diagonal = 0.70710678f;
+
+// the grid and its placement in the world, shared by both kernels
+struct Frame {
+    const uint8_t* bytes;   // the wall bits, row y starting at byte y * rowBytes
+    size_t rowBytes;
+    int width;
+    int height;
+    float originX;
+    float originZ;
+    float cellSize;
+    float scale;            // 1 / cellSize
+};
+
+// 32 wall bits starting at the given byte; rows are followed by the boundary words, so the read
+// never leaves the grid's storage
+inline uint32_t loadWindow(const uint8_t* bytes)
+{
+    uint32_t window;
+    memcpy(&window, bytes, sizeof(window));
+    return window;
+}
+
+inline bool bitAt(uint32_t window, int shift)
+{
+    return (shift >= 0) & ((window >> (shift & 31)) & 1u);
+}
+
+// check one circle, true when it overlapped a wall
+bool resolveOne(const Frame& frame, float worldX, float worldZ, float worldRadius, float& outX, float& outZ)
+{
+    float radius = min(worldRadius * frame.scale, CollisionBatch::maxRadius);
+    float x = min(max((worldX - frame.originX) * frame.scale, 0.0f), float(frame.width));
+    float z = min(max((worldZ - frame.originZ) * frame.scale, 0.0f), float(frame.height));
+
+    // Nearest grid point; only the four segments meeting there are within reach. Truncation
+    // rounds down, x and z are not negative
+    int gx = static_cast<int>(x + 0.5f);
+    int gz = static_cast<int>(z + 0.5f);
+    float gridX = float(gx);
+    float gridZ = float(gz);
+    float dx = x - gridX;
+    float dz = z - gridZ;
+
+    // Bits of columns gx - 1 and gx in rows gz - 1 (above the point) and gz (below it)
+    int rowAbove = min(max(gz - 1, 0), frame.height - 1);
+    int rowBelow = min(gz, frame.height - 1);
+    int byteOffset = max(gx - 1, 0) >> 2;
+    int position = 2 * gx - 8 * byteOffset;
+    uint32_t above = loadWindow(frame.bytes + rowAbove * frame.rowBytes + byteOffset);
+    uint32_t below = loadWindow(frame.bytes + rowBelow * frame.rowBytes + byteOffset);
+
+    // Segments from the point to the left, right, up and down; the boundary lines are always walls
+    bool boundaryZ = (gz == 0) | (gz == frame.height);
+    bool boundaryX = (gx == 0) | (gx == frame.width);
+    bool left = ((gz > 0) & bitAt(above, position - 1)) | boundaryZ;
+    bool right = ((gz > 0) & (gx < frame.width) & bitAt(above, position + 1)) | boundaryZ;
+    bool up = ((gz > 0) & bitAt(above, position - 2)) | boundaryX;
+    bool down = ((gz < frame.height) & bitAt(below, position - 2)) | boundaryX;
+
+    // Flat sides of the segments on the circle's side of the point, then the point itself; the
+    // usual case of no contact is kept free of branches
+    float push = radius + skin;
+    bool hitZ = (dx < 0.0f ? left : right) & (fabs(dz) < radius);
+    bool hitX = (dz < 0.0f ? up : down) & (fabs(dx) < radius);
+    float pushedZ = dz < 0.0f ? -push : push;
+    float pushedX = dx < 0.0f ? -push : push;
+    dz = hitZ ? pushedZ : dz;
+    dx = hitX ? pushedX : dx;
+    float distanceSquared = dx * dx + dz * dz;
+    bool hitCorner = (left | right | up | down) & (distanceSquared < radius * radius);
+    if (hitCorner) {
+        float distance = sqrt(distanceSquared);
+        if (distance > 1e-6f) {
+            float factor = push / distance;
+            dx = dx * factor;
+            dz = dz * factor;
+        } else {
+            dx = dx < 0.0f ? -push * diagonal : push * diagonal;
+            dz = dz < 0.0f ? -push * diagonal : push * diagonal;
+        }
+    }
+
+    bool hit = hitZ | hitX | hitCorner;
+    outX = hit ? frame.originX + (gridX + dx) * frame.cellSize : worldX;
+    outZ = hit ? frame.originZ + (gridZ + dz) * frame.cellSize : worldZ;
+    return hit;
+}
+
+// circles [first, last) one at a time; first is a multiple of 8
+size_t resolveScalar(const Frame& frame, const float* xs, const float* zs, const float* radii, size_t first,
+                     size_t last, float* outXs, float* outZs, uint8_t* hitBits)
+{
+    size_t hitCount = 0;
+    uint8_t hitByte = 0;
+    for (size_t i = first; i < last; i++) {
+        bool hit = resolveOne(frame, xs[i], zs[i], radii[i], outXs[i], outZs[i]);
+        hitByte |= uint8_t(hit) << (i & 7);
+        hitCount += hit;
+        if ((i & 7) == 7 || i + 1 == last) {
+            hitBits[i >> 3] = hitByte;
+            hitByte = 0;
+        }
+    }
+    return hitCount;
+}
+
+#ifdef COLLISION_BATCH_X86
+
+// all ones in the lanes whose bit at shift is set; negative shifts give zero
+__attribute__((target("avx2")))
+inline __m256i wallBits(__m256i window, __m256i shift, __m256i one)
+{
+    return _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_srlv_epi32(window, shift), one), one);
+}
+
+// resolveOne for circles [0, count) eight at a time; count is a multiple of 8
+__attribute__((target("avx2")))
+size_t resolveAvx2(const Frame& frame, const float* xs, const float* zs, const float* radii, size_t count,
+                   float* outXs, float* outZs, uint8_t* hitBits)
+{
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+    const __m256 maxRadius = _mm256_set1_ps(CollisionBatch::maxRadius);
+    const __m256 skinWidth = _mm256_set1_ps(skin);
+    const __m256 diagonalScale = _mm256_set1_ps(diagonal);
+    const __m256 onPointDistance = _mm256_set1_ps(1e-6f);
+    const __m256 originX = _mm256_set1_ps(frame.originX);
+    const __m256 originZ = _mm256_set1_ps(frame.originZ);
+    const __m256 cellSize = _mm256_set1_ps(frame.cellSize);
+    const __m256 scale = _mm256_set1_ps(frame.scale);
+    const __m256 widthCells = _mm256_set1_ps(float(frame.width));
+    const __m256 heightCells = _mm256_set1_ps(float(frame.height));
+    const __m256i zeroInt = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i two = _mm256_set1_epi32(2);
+    const __m256i width = _mm256_set1_epi32(frame.width);
+    const __m256i height = _mm256_set1_epi32(frame.height);
+    const __m256i lastRow = _mm256_set1_epi32(frame.height - 1);
+    const __m256i rowBytes = _mm256_set1_epi32(static_cast<int>(frame.rowBytes));
+    const int* base = reinterpret_cast<const int*>(frame.bytes);
+
+    size_t hitCount = 0;
+    for (size_t i = 0; i < count; i += 8) {
+        __m256 worldX = _mm256_loadu_ps(xs + i);
+        __m256 worldZ = _mm256_loadu_ps(zs + i);
+        __m256 radius = _mm256_min_ps(_mm256_mul_ps(_mm256_loadu_ps(radii + i), scale), maxRadius);
+        __m256 x = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_sub_ps(worldX, originX), scale), zero), widthCells);
+        __m256 z = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_sub_ps(worldZ, originZ), scale), zero), heightCells);
+
+        // Nearest grid point
+        __m256i gx = _mm256_cvttps_epi32(_mm256_add_ps(x, half));
+        __m256i gz = _mm256_cvttps_epi32(_mm256_add_ps(z, half));
+        __m256 gridX = _mm256_cvtepi32_ps(gx);
+        __m256 gridZ = _mm256_cvtepi32_ps(gz);
+        __m256 dx = _mm256_sub_ps(x, gridX);
+        __m256 dz = _mm256_sub_ps(z, gridZ);
+
+        // Gather the two 32-bit windows of wall bits around the point
+        __m256i rowAbove = _mm256_min_epi32(_mm256_max_epi32(_mm256_sub_epi32(gz, one), zeroInt), lastRow);
+        __m256i rowBelow = _mm256_min_epi32(gz, lastRow);
+        __m256i byteOffset = _mm256_srai_epi32(_mm256_max_epi32(_mm256_sub_epi32(gx, one), zeroInt), 2);
+        __m256i position = _mm256_sub_epi32(_mm256_slli_epi32(gx, 1), _mm256_slli_epi32(byteOffset, 3));
+        __m256i above = _mm256_i32gather_epi32(base, _mm256_add_epi32(_mm256_mullo_epi32(rowAbove, rowBytes), byteOffset), 1);
+        __m256i below = _mm256_i32gather_epi32(base, _mm256_add_epi32(_mm256_mullo_epi32(rowBelow, rowBytes), byteOffset), 1);
+
+        // Segments from the point, as lane masks
+        __m256i hasAbove = _mm256_cmpgt_epi32(gz, zeroInt);
+        __m256i boundaryZ = _mm256_or_si256(_mm256_cmpeq_epi32(gz, zeroInt), _mm256_cmpeq_epi32(gz, height));
+        __m256i boundaryX = _mm256_or_si256(_mm256_cmpeq_epi32(gx, zeroInt), _mm256_cmpeq_epi32(gx, width));
+        __m256i leftBits = _mm256_and_si256(hasAbove, wallBits(above, _mm256_sub_epi32(position, one), one));
+        __m256i rightBits = _mm256_and_si256(_mm256_and_si256(hasAbove, _mm256_cmpgt_epi32(width, gx)),
+                                             wallBits(above, _mm256_add_epi32(position, one), one));
+        __m256i upBits = _mm256_and_si256(hasAbove, wallBits(above, _mm256_sub_epi32(position, two), one));
+        __m256i downBits = _mm256_and_si256(_mm256_cmpgt_epi32(height, gz),
+                                            wallBits(below, _mm256_sub_epi32(position, two), one));
+        __m256 left = _mm256_castsi256_ps(_mm256_or_si256(leftBits, boundaryZ));
+        __m256 right = _mm256_castsi256_ps(_mm256_or_si256(rightBits, boundaryZ));
+        __m256 up = _mm256_castsi256_ps(_mm256_or_si256(upBits, boundaryX));
+        __m256 down = _mm256_castsi256_ps(_mm256_or_si256(downBits, boundaryX));
+
+        // Flat sides
+        __m256 push = _mm256_add_ps(radius, skinWidth);
+        __m256 dxNegative = _mm256_cmp_ps(dx, zero, _CMP_LT_OQ);
+        __m256 dzNegative = _mm256_cmp_ps(dz, zero, _CMP_LT_OQ);
+        __m256 hitZ = _mm256_and_ps(_mm256_blendv_ps(right, left, dxNegative),
+                                    _mm256_cmp_ps(_mm256_andnot_ps(signMask, dz), radius, _CMP_LT_OQ));
+        __m256 hitX = _mm256_and_ps(_mm256_blendv_ps(down, up, dzNegative),
+                                    _mm256_cmp_ps(_mm256_andnot_ps(signMask, dx), radius, _CMP_LT_OQ));
+        __m256 pushedX = _mm256_blendv_ps(push, _mm256_xor_ps(push, signMask), dxNegative);
+        __m256 pushedZ = _mm256_blendv_ps(push, _mm256_xor_ps(push, signMask), dzNegative);
+        dz = _mm256_blendv_ps(dz, pushedZ, hitZ);
+        dx = _mm256_blendv_ps(dx, pushedX, hitX);
+
+        // The point, pushed out radially (diagonally when exactly on it)
+        __m256 post = _mm256_or_ps(_mm256_or_ps(left, right), _mm256_or_ps(up, down));
+        __m256 distanceSquared = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dz, dz));
+        __m256 hitCorner = _mm256_and_ps(post, _mm256_cmp_ps(distanceSquared, _mm256_mul_ps(radius, radius), _CMP_LT_OQ));
+        __m256 distance = _mm256_sqrt_ps(distanceSquared);
+        __m256 factor = _mm256_div_ps(push, distance);
+        __m256 onPoint = _mm256_cmp_ps(distance, onPointDistance, _CMP_LE_OQ);
+        __m256 diagonalPush = _mm256_mul_ps(push, diagonalScale);
+        __m256 cornerX = _mm256_blendv_ps(_mm256_mul_ps(dx, factor),
+                                          _mm256_blendv_ps(diagonalPush, _mm256_xor_ps(diagonalPush, signMask), dxNegative),
+                                          onPoint);
+        __m256 cornerZ = _mm256_blendv_ps(_mm256_mul_ps(dz, factor),
+                                          _mm256_blendv_ps(diagonalPush, _mm256_xor_ps(diagonalPush, signMask), dzNegative),
+                                          onPoint);
+        dx = _mm256_blendv_ps(dx, cornerX, hitCorner);
+        dz = _mm256_blendv_ps(dz, cornerZ, hitCorner);
+
+        __m256 hit = _mm256_or_ps(_mm256_or_ps(hitZ, hitX), hitCorner);
+        __m256 resolvedX = _mm256_add_ps(originX, _mm256_mul_ps(_mm256_add_ps(gridX, dx), cellSize));
+        __m256 resolvedZ = _mm256_add_ps(originZ, _mm256_mul_ps(_mm256_add_ps(gridZ, dz), cellSize));
+        _mm256_storeu_ps(outXs + i, _mm256_blendv_ps(worldX, resolvedX, hit));
+        _mm256_storeu_ps(outZs + i, _mm256_blendv_ps(worldZ, resolvedZ, hit));
+
+        unsigned int mask = static_cast<unsigned int>(_mm256_movemask_ps(hit));
+        hitBits[i >> 3] = static_cast<uint8_t>(mask);
+        hitCount += __builtin_popcount(mask);
+    }
+    return hitCount;
+}
+
+#endif
+
+}
+
+// check count circles against the walls, pushing the overlapping ones out
+size_t CollisionBatch::resolve(const WallGrid& walls, float originX, float originZ, float cellSize,
+                               const float* xs, const float* zs, const float* radii, size_t count,
+                               float* outXs, float* outZs, uint8_t* hitBits, Kernel kernel)
+{
+    if (count == 0) {
+        return 0;
+    }
+    if (walls.getWidth() <= 0 || walls.getHeight() <= 0) {
+        copy(xs, xs + count, outXs);
+        copy(zs, zs + count, outZs);
+        fill(hitBits, hitBits + (count + 7) / 8, uint8_t(0));
+        return 0;
+    }
+
+    Frame frame;
+    frame.bytes = reinterpret_cast<const uint8_t*>(walls.wordData());
+    frame.rowBytes = walls.getRowWords() * sizeof(uint64_t);
+    frame.width = walls.getWidth();
+    frame.height = walls.getHeight();
+    frame.originX = originX;
+    frame.originZ = originZ;
+    frame.cellSize = cellSize;
+    frame.scale = 1.0f / cellSize;
+
+    if (kernel == AUTO || bestKernel() == SCALAR) {
+        kernel = bestKernel();
+    }
+
+    size_t done = 0;
+    size_t hitCount = 0;
+#ifdef COLLISION_BATCH_X86
+    // The gathers index the rows with 32-bit byte offsets
+    if (kernel == AVX2 && frame.rowBytes * frame.height <= 0x7fffffffu) {
+        done = count & ~size_t(7);
+        hitCount = resolveAvx2(frame, xs, zs, radii, done, outXs, outZs, hitBits);
+    }
+#endif
+    return hitCount + resolveScalar(frame, xs, zs, radii, done, count, outXs, outZs, hitBits);
+}
+
+// the kernel AUTO picks on this CPU
+CollisionBatch::Kernel CollisionBatch::bestKernel()
+{
+#ifdef COLLISION_BATCH_X86
+    static const Kernel best = __builtin_cpu_supports("avx2") ? AVX2 : SCALAR;
+    return best;
+#else
+    return SCALAR;
+#endif
+}
+
+const char* CollisionBatch::kernelName(Kernel kernel)
+{
+    switch (kernel) {
+    case SCALAR:
+        return "scalar";
+    case AVX2:
+        return "avx2";
+    default:
+        return kernelName(bestKernel());
+    }
+}
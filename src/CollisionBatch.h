@@ -0,0 +1,49 @@
+#ifndef COLLISIONBATCH_H
+#define COLLISIONBATCH_H
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "WallGrid.h"
+
+using namespace std;
+
+// Collision of many circles against the maze walls at once, for crowds of moving bodies.
+// Positions and radii come in as separate arrays (x[], z[], radius[]); every circle that
+// overlaps a wall is pushed out of it, like the last step of CircleCollider::move, and flagged
+// in a bit mask. A circle under half a cell wide can only reach the four wall segments that meet
+// at the grid point nearest to it, so each check is two 32-bit reads from the bit-packed rows
+// around that point and a few branch-free float operations. On x86 CPUs with AVX2 eight circles
+// are checked per instruction, with gathers straight from the wall bits; elsewhere (and for the
+// last few circles) a scalar kernel computes the same results.
+// The outer boundary of the grid always counts as a wall, as in CircleCollider.
+class CollisionBatch
+{
+public:
+    // Kernel that checks the circles
+    enum Kernel {
+        AUTO,       // the fastest one the CPU supports
+        SCALAR,     // one circle at a time, any CPU
+        AVX2        // eight circles at a time, x86 with AVX2
+    };
+
+    // largest radius in cells; larger circles are checked with this radius
+    static constexpr float maxRadius = 0.49f;
+
+    // check count circles (world x, z and radius, the clearance from the wall center lines) against
+    // the walls of a maze whose cell (0, 0) starts at (originX, originZ): writes the positions pushed
+    // out of the walls to outXs, outZs (may be xs, zs; circles that touch nothing keep theirs) and
+    // sets bit i % 8 of hitBits[i / 8] for each circle i that overlapped a wall, clearing the others.
+    // Returns how many overlapped
+    static size_t resolve(const WallGrid& walls, float originX, float originZ, float cellSize,
+                          const float* xs, const float* zs, const float* radii, size_t count,
+                          float* outXs, float* outZs, uint8_t* hitBits, Kernel kernel = AUTO);
+
+    // the kernel AUTO picks on this CPU, and its name
+    static Kernel bestKernel();
+    static const char* kernelName(Kernel kernel);
+};
+
+#endif
@@ -0,0 +1,274 @@
+#include "DistanceField.h"
+
+#include <algorithm>
+
+namespace {
+
+// Neighbour offsets in WallGrid order (N, S, W, E)
+const int dx[4] = { 0, 0, -1, 1 };
+const int dy[4] = { -1, 1, 0, 0 };
+
+}
+
+DistanceField::DistanceField()
+    : width(0), height(0), targetX(0), targetY(0), wide(false), updatedCount(0)
+{
+}
+
+// distances from every cell to (targetX, targetY) through open walls
+void DistanceField::build(const WallGrid& walls, int targetX, int targetY)
+{
+    clear();
+    if (walls.getWidth() <= 0 || walls.getHeight() <= 0 ||
+        targetX < 0 || targetX >= walls.getWidth() || targetY < 0 || targetY >= walls.getHeight()) {
+        return;
+    }
+
+    width = walls.getWidth();
+    height = walls.getHeight();
+    this->targetX = targetX;
+    this->targetY = targetY;
+
+    // In a grid of at most 65535 cells no distance reaches 0xffff, which marks unreachable cells
+    size_t cellCount = static_cast<size_t>(width) * height;
+    wide = cellCount > 0xffff;
+    if (wide)
+        wideDistances.assign(cellCount, unreachable);
+    else
+        narrowDistances.assign(cellCount, 0xffff);
+
+    size_t target = static_cast<size_t>(targetY) * width + targetX;
+    set(target, 0);
+    propagateDecrease(walls, target);
+    updatedCount++;
+}
+
+// drop the field
+void DistanceField::clear()
+{
+    width = 0;
+    height = 0;
+    updatedCount = 0;
+    narrowDistances.clear();
+    wideDistances.clear();
+}
+
+// open neighbours of a cell as a N, S, W, E bit mask (walls out of the grid do not count)
+uint32_t DistanceField::openMask(const WallGrid& walls, int x, int y) const
+{
+    return static_cast<uint32_t>(y > 0 && !walls.hasWall(x, y, WallGrid::NORTH))
+         | static_cast<uint32_t>(y < height - 1 && !walls.hasWall(x, y, WallGrid::SOUTH)) << 1
+         | static_cast<uint32_t>(x > 0 && !walls.hasWall(x, y, WallGrid::WEST)) << 2
+         | static_cast<uint32_t>(x < width - 1 && !walls.hasWall(x, y, WallGrid::EAST)) << 3;
+}
+
+// direction of the first step from (x, y) toward the target
+bool DistanceField::nextStep(const WallGrid& walls, int x, int y, WallGrid::Direction& direction) const
+{
+    if (!isBuilt() || x < 0 || x >= width || y < 0 || y >= height) {
+        return false;
+    }
+    uint32_t distance = getDistance(x, y);
+    if (distance == 0 || distance == unreachable) {
+        return false;
+    }
+
+    uint32_t open = openMask(walls, x, y);
+    for (int dir = 0; dir < 4; dir++) {
+        if ((open >> dir & 1u) && getDistance(x + dx[dir], y + dy[dir]) < distance) {
+            direction = static_cast<WallGrid::Direction>(dir);
+            return true;
+        }
+    }
+    return false;
+}
+
+// repair the field after the given wall of (x, y) was added or removed in walls
+void DistanceField::wallChanged(const WallGrid& walls, int x, int y, WallGrid::Direction direction)
+{
+    updatedCount = 0;
+    int nx = x + dx[direction];
+    int ny = y + dy[direction];
+    if (!isBuilt() || x < 0 || x >= width || y < 0 || y >= height || nx < 0 || nx >= width || ny < 0 || ny >= height) {
+        return;
+    }
+
+    size_t cell = static_cast<size_t>(y) * width + x;
+    size_t neighbour = static_cast<size_t>(ny) * width + nx;
+    uint32_t distance = get(cell);
+    uint32_t neighbourDistance = get(neighbour);
+
+    if (!walls.hasWall(x, y, direction)) {
+        // A new opening can only shorten distances, starting at the farther of the two cells
+        if (distance != unreachable && distance + 1 < neighbourDistance) {
+            set(neighbour, distance + 1);
+            updatedCount++;
+            propagateDecrease(walls, neighbour);
+        }
+        else if (neighbourDistance != unreachable && neighbourDistance + 1 < distance) {
+            set(cell, neighbourDistance + 1);
+            updatedCount++;
+            propagateDecrease(walls, cell);
+        }
+        return;
+    }
+
+    // A new wall only matters when the farther cell's shortest way led through it
+    if (distance != unreachable && neighbourDistance == distance + 1)
+        repairIncrease(walls, neighbour);
+    else if (neighbourDistance != unreachable && distance == neighbourDistance + 1)
+        repairIncrease(walls, cell);
+}
+
+// breadth-first search outward from a cell whose distance just became smaller
+void DistanceField::propagateDecrease(const WallGrid& walls, size_t cell)
+{
+    frontier.clear();
+    frontier.push_back(static_cast<uint32_t>(cell));
+    uint32_t level = get(cell);
+
+    while (!frontier.empty()) {
+        nextFrontier.clear();
+        for (uint32_t current : frontier) {
+            int x = static_cast<int>(current % static_cast<uint32_t>(width));
+            int y = static_cast<int>(current / static_cast<uint32_t>(width));
+            uint32_t open = openMask(walls, x, y);
+            for (int dir = 0; dir < 4; dir++) {
+                if (!(open >> dir & 1u)) {
+                    continue;
+                }
+                size_t neighbour = static_cast<size_t>(y + dy[dir]) * width + (x + dx[dir]);
+                if (get(neighbour) > level + 1) {
+                    set(neighbour, level + 1);
+                    nextFrontier.push_back(static_cast<uint32_t>(neighbour));
+                }
+            }
+        }
+        updatedCount += nextFrontier.size();
+        frontier.swap(nextFrontier);
+        level++;
+    }
+}
+
+// a wall cut the shortest way of cell: find every cell that lost its way and search their distances again
+void DistanceField::repairIncrease(const WallGrid& walls, size_t cell)
+{
+    size_t cellCount = static_cast<size_t>(width) * height;
+    if (affectedBits.size() != (cellCount + 63) / 64) {
+        affectedBits.assign((cellCount + 63) / 64, 0);
+    }
+    auto isAffected = [&](size_t index) { return (affectedBits[index >> 6] >> (index & 63)) & 1u; };
+    size_t target = static_cast<size_t>(targetY) * width + targetX;
+
+    // A cell keeps its distance while an open neighbour one step closer did not lose its own
+    auto hasSupport = [&](size_t index, uint32_t distance) {
+        if (index == target) {
+            return true;
+        }
+        int x = static_cast<int>(index % width);
+        int y = static_cast<int>(index / width);
+        uint32_t open = openMask(walls, x, y);
+        for (int dir = 0; dir < 4; dir++) {
+            size_t neighbour = static_cast<size_t>(y + dy[dir]) * width + (x + dx[dir]);
+            if ((open >> dir & 1u) && get(neighbour) + 1 == distance && !isAffected(neighbour)) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    // Collect the cells that lost their way, level by level outward from the cut
+    affected.clear();
+    frontier.clear();
+    frontier.push_back(static_cast<uint32_t>(cell));
+    uint32_t level = get(cell);
+    while (!frontier.empty()) {
+        nextFrontier.clear();
+        for (uint32_t current : frontier) {
+            if (isAffected(current) || hasSupport(current, level)) {
+                continue;
+            }
+            affectedBits[current >> 6] |= uint64_t(1) << (current & 63);
+            affected.push_back(current);
+
+            int x = static_cast<int>(current % static_cast<uint32_t>(width));
+            int y = static_cast<int>(current / static_cast<uint32_t>(width));
+            uint32_t open = openMask(walls, x, y);
+            for (int dir = 0; dir < 4; dir++) {
+                size_t neighbour = static_cast<size_t>(y + dy[dir]) * width + (x + dx[dir]);
+                if ((open >> dir & 1u) && get(neighbour) == level + 1) {
+                    nextFrontier.push_back(static_cast<uint32_t>(neighbour));
+                }
+            }
+        }
+        frontier.swap(nextFrontier);
+        level++;
+    }
+
+    // Their new distances come from the unaffected cells around them
+    for (uint32_t current : affected) {
+        set(current, unreachable);
+    }
+    seeds.clear();
+    for (uint32_t current : affected) {
+        int x = static_cast<int>(current % static_cast<uint32_t>(width));
+        int y = static_cast<int>(current / static_cast<uint32_t>(width));
+        uint32_t open = openMask(walls, x, y);
+        uint32_t best = unreachable;
+        for (int dir = 0; dir < 4; dir++) {
+            size_t neighbour = static_cast<size_t>(y + dy[dir]) * width + (x + dx[dir]);
+            if ((open >> dir & 1u) && !isAffected(neighbour) && get(neighbour) != unreachable) {
+                best = min(best, get(neighbour) + 1);
+            }
+        }
+        if (best != unreachable) {
+            seeds.push_back({ best, current });
+        }
+    }
+    sort(seeds.begin(), seeds.end());
+
+    // Breadth-first search from every seed, each joining when the search reaches its distance
+    size_t nextSeed = 0;
+    frontier.clear();
+    while (nextSeed < seeds.size() || !frontier.empty()) {
+        if (frontier.empty()) {
+            level = seeds[nextSeed].first;
+        }
+        for (; nextSeed < seeds.size() && seeds[nextSeed].first <= level; nextSeed++) {
+            uint32_t current = seeds[nextSeed].second;
+            if (get(current) > level) {
+                set(current, level);
+                frontier.push_back(current);
+            }
+        }
+
+        nextFrontier.clear();
+        for (uint32_t current : frontier) {
+            int x = static_cast<int>(current % static_cast<uint32_t>(width));
+            int y = static_cast<int>(current / static_cast<uint32_t>(width));
+            uint32_t open = openMask(walls, x, y);
+            for (int dir = 0; dir < 4; dir++) {
+                size_t neighbour = static_cast<size_t>(y + dy[dir]) * width + (x + dx[dir]);
+                if ((open >> dir & 1u) && get(neighbour) > level + 1) {
+                    set(neighbour, level + 1);
+                    nextFrontier.push_back(static_cast<uint32_t>(neighbour));
+                }
+            }
+        }
+        frontier.swap(nextFrontier);
+        level++;
+    }
+
+    for (uint32_t current : affected) {
+        affectedBits[current >> 6] &= ~(uint64_t(1) << (current & 63));
+    }
+    updatedCount = affected.size();
+}
+
+// bytes used by the distances and the repair scratch
+size_t DistanceField::memoryBytes() const
+{
+    return narrowDistances.capacity() * sizeof(uint16_t) + wideDistances.capacity() * sizeof(uint32_t) +
+           (frontier.capacity() + nextFrontier.capacity() + affected.capacity()) * sizeof(uint32_t) +
+           affectedBits.capacity() * sizeof(uint64_t) + seeds.capacity() * sizeof(pair<uint32_t, uint32_t>);
+}
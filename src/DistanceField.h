@@ -0,0 +1,100 @@
+#ifndef DISTANCEFIELD_H
+#define DISTANCEFIELD_H
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "WallGrid.h"
+
+using namespace std;
+
+// Walking distance from every cell to one target cell, kept in a flat array.
+// Built with one breadth-first search; afterwards "how far to the target" is a lookup
+// and "which way to the target" compares the distances of the open neighbours.
+// Distances are 16 bits per cell while every distance fits (grids up to 65535 cells),
+// 32 bits otherwise. When a wall is added or removed the field is repaired in place,
+// touching only the cells whose distance actually changes.
+class DistanceField
+{
+public:
+    // distance of cells that cannot reach the target
+    static constexpr uint32_t unreachable = 0xffffffffu;
+
+    DistanceField();
+
+    // distances from every cell to (targetX, targetY) through open walls
+    void build(const WallGrid& walls, int targetX, int targetY);
+
+    // drop the field (e.g. after a new maze was generated)
+    void clear();
+    bool isBuilt() const { return width > 0; }
+
+    // walking distance from (x, y) to the target in cells, or unreachable
+    uint32_t getDistance(int x, int y) const { return get(static_cast<size_t>(y) * width + x); }
+
+    // direction of the first step from (x, y) toward the target; false at the target or when it cannot be reached
+    bool nextStep(const WallGrid& walls, int x, int y, WallGrid::Direction& direction) const;
+
+    // repair the field after the given wall of (x, y) was added or removed in walls
+    void wallChanged(const WallGrid& walls, int x, int y, WallGrid::Direction direction);
+
+    int getTargetX() const { return targetX; }
+    int getTargetY() const { return targetY; }
+
+    // true when distances are stored in 32 bits
+    bool isWide() const { return wide; }
+
+    // cells whose distance the last build or repair set
+    size_t getUpdatedCount() const { return updatedCount; }
+
+    // bytes used by the distances and the repair scratch
+    size_t memoryBytes() const;
+
+private:
+    int width;
+    int height;
+    int targetX;
+    int targetY;
+    bool wide;
+    vector<uint16_t> narrowDistances;
+    vector<uint32_t> wideDistances;
+    size_t updatedCount;
+
+    // search scratch, kept between repairs
+    vector<uint32_t> frontier;
+    vector<uint32_t> nextFrontier;
+    vector<uint32_t> affected;
+    vector<uint64_t> affectedBits;
+    vector<pair<uint32_t, uint32_t>> seeds;   // (distance, cell)
+
+    uint32_t get(size_t cell) const;
+    void set(size_t cell, uint32_t distance);
+
+    // open neighbours of a cell as a N, S, W, E bit mask
+    uint32_t openMask(const WallGrid& walls, int x, int y) const;
+
+    void propagateDecrease(const WallGrid& walls, size_t cell);
+    void repairIncrease(const WallGrid& walls, size_t cell);
+};
+
+inline uint32_t DistanceField::get(size_t cell) const
+{
+    if (wide)
+        return wideDistances[cell];
+    uint16_t distance = narrowDistances[cell];
+    return distance == 0xffff ? unreachable : distance;
+}
+
+inline void DistanceField::set(size_t cell, uint32_t distance)
+{
+    if (wide)
+        wideDistances[cell] = distance;
+    else
+        narrowDistances[cell] = distance == unreachable ? 0xffff : static_cast<uint16_t>(distance);
+}
+
+#endif
@@ -1,40 +1,34 @@
 #ifndef FLOOR_H
 #define FLOOR_H
 
-#include <GL/glew.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
-#include <glm/gtc/type_ptr.hpp>
-#include "stb_image.h"
 #include <string>
 
-#include "shaders.h"
 using namespace std;
 
+// A horizontal floor quad of the maze. Floors hold no GL resources of their
+// own, they are baked into a MazeMesh.
 class Floor
 {
 public:
     // Constructor
     Floor(const glm::vec3& position, const glm::vec2& size, const string& texturePath);
     
-    // Destructor
-    ~Floor();
-    
     // Set the position of the floor
     void setPosition(const glm::vec3& position);
     glm::vec3 getPosition() const;
- 
-    // render the floor
-    void render(shaders* shader, const glm::mat4& view, const glm::mat4& projection);
+
+    glm::vec2 getSize() const;
+    const string& getTexturePath() const;
+
+    // model matrix that places the unit floor quad in the world
+    glm::mat4 getModelMatrix() const;
 
 private:
-    unsigned int VAO, VBO;
-    unsigned int textureID;
+    string texturePath;
     glm::vec3 position;
     glm::vec2 size;  // x and z dimensions
-
-    void setupFloor();
-    void loadTexture(const string& path);
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,120 @@
+#include "FlowFieldCache.h"
+
+namespace {
+
+// Neighbour offsets and the direction leading back, in WallGrid order (N, S, W, E)
+const int dx[4] = { 0, 0, -1, 1 };
+const int dy[4] = { -1, 1, 0, 0 };
+const uint8_t back[4] = { WallGrid::SOUTH, WallGrid::NORTH, WallGrid::EAST, WallGrid::WEST };
+
+}
+
+FlowFieldCache::FlowFieldCache(size_t budgetBytes)
+    : budget(budgetBytes), usedBytes(0), queue(1024), hits(0), misses(0), evictions(0)
+{
+}
+
+// field toward the target cell, built on a miss
+const uint8_t* FlowFieldCache::getField(const WallGrid& walls, uint32_t target)
+{
+    size_t cellCount = static_cast<size_t>(walls.getWidth()) * walls.getHeight();
+    if (target >= cellCount) {
+        return nullptr;
+    }
+
+    auto it = byTarget.find(target);
+    if (it != byTarget.end()) {
+        // Move to the front, the most recently used end
+        fields.splice(fields.begin(), fields, it->second);
+        hits++;
+        return fields.front().directions.data();
+    }
+
+    misses++;
+    fields.push_front(Field{ target, vector<uint8_t>() });
+    byTarget[target] = fields.begin();
+    build(walls, target, fields.front().directions);
+    usedBytes += fields.front().directions.size();
+    evict();
+    return fields.front().directions.data();
+}
+
+// one breadth-first search from the target; every reached cell points back along the search
+void FlowFieldCache::build(const WallGrid& walls, uint32_t target, vector<uint8_t>& directions)
+{
+    int width = walls.getWidth();
+    int height = walls.getHeight();
+    size_t cellCount = static_cast<size_t>(width) * height;
+    directions.assign(cellCount, unreachable);
+
+    // The queue only grows to the widest search front
+    directions[target] = atTarget;
+    queue[0] = target;
+    size_t head = 0;
+    size_t count = 1;
+    size_t mask = queue.size() - 1;
+    while (count > 0) {
+        uint32_t cell = queue[head];
+        head = (head + 1) & mask;
+        count--;
+
+        int y = static_cast<int>(cell / static_cast<uint32_t>(width));
+        int x = static_cast<int>(cell - static_cast<uint32_t>(y) * static_cast<uint32_t>(width));
+        for (int dir = 0; dir < 4; dir++) {
+            int nx = x + dx[dir];
+            int ny = y + dy[dir];
+            if (nx < 0 || nx >= width || ny < 0 || ny >= height ||
+                walls.hasWall(x, y, static_cast<WallGrid::Direction>(dir))) {
+                continue;
+            }
+            uint32_t neighbour = static_cast<uint32_t>(ny) * width + nx;
+            if (directions[neighbour] != unreachable) {
+                continue;
+            }
+            directions[neighbour] = back[dir];
+
+            if (count == queue.size()) {
+                vector<uint32_t> larger(queue.size() * 2);
+                for (size_t i = 0; i < count; i++) {
+                    larger[i] = queue[(head + i) & mask];
+                }
+                queue.swap(larger);
+                head = 0;
+                mask = queue.size() - 1;
+            }
+            queue[(head + count) & mask] = neighbour;
+            count++;
+        }
+    }
+}
+
+// change the budget, evicting the least recently used fields over it
+void FlowFieldCache::setBudget(size_t budgetBytes)
+{
+    budget = budgetBytes;
+    evict();
+}
+
+// drop every field
+void FlowFieldCache::clear()
+{
+    fields.clear();
+    byTarget.clear();
+    usedBytes = 0;
+}
+
+void FlowFieldCache::evict()
+{
+    while (usedBytes > budget && fields.size() > 1) {
+        usedBytes -= fields.back().directions.size();
+        byTarget.erase(fields.back().target);
+        fields.pop_back();
+        evictions++;
+    }
+}
+
+// bytes held by the fields and the search queue
+size_t FlowFieldCache::memoryBytes() const
+{
+    return usedBytes + queue.capacity() * sizeof(uint32_t);
+}
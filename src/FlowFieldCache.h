@@ -0,0 +1,72 @@
+#ifndef FLOWFIELDCACHE_H
+#define FLOWFIELDCACHE_H
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include "WallGrid.h"
+
+using namespace std;
+
+// Flow fields for crowds sharing a destination, cached per target cell.
+// A flow field holds one byte per cell: the direction (WallGrid::Direction) of the first step
+// toward the target, so an agent steers with a single lookup per tick however far it is.
+// Each field costs one breadth-first search from the target. Fields are kept in least recently
+// used order and evicted once their bytes (one per cell each) exceed the budget; the field just
+// asked for always stays, even when it alone is over the budget.
+class FlowFieldCache
+{
+public:
+    // field values besides the four directions
+    static constexpr uint8_t atTarget = 4;
+    static constexpr uint8_t unreachable = 0xff;
+
+    // budget in field bytes (one per cell and field)
+    explicit FlowFieldCache(size_t budgetBytes = size_t(64) << 20);
+
+    // field toward the target cell (y * width + x), built on a miss; the pointer stays valid until
+    // the next getField, setBudget or clear
+    const uint8_t* getField(const WallGrid& walls, uint32_t target);
+
+    // change the budget, evicting the least recently used fields over it
+    void setBudget(size_t budgetBytes);
+    size_t getBudget() const { return budget; }
+
+    // drop every field (e.g. after the walls changed)
+    void clear();
+
+    size_t getFieldCount() const { return fields.size(); }
+    size_t getHitCount() const { return hits; }
+    size_t getMissCount() const { return misses; }
+    size_t getEvictionCount() const { return evictions; }
+
+    // bytes held by the fields and the search queue
+    size_t memoryBytes() const;
+
+private:
+    struct Field {
+        uint32_t target;
+        vector<uint8_t> directions;
+    };
+
+    size_t budget;
+    size_t usedBytes;
+    list<Field> fields;                                     // most recently used first
+    unordered_map<uint32_t, list<Field>::iterator> byTarget;
+    vector<uint32_t> queue;     // ring buffer of cell indices, size a power of two
+    size_t hits;
+    size_t misses;
+    size_t evictions;
+
+    void build(const WallGrid& walls, uint32_t target, vector<uint8_t>& directions);
+
+    // evict from the back until the fields fit, keeping the front one
+    void evict();
+};
+
+#endif
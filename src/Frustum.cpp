@@ -0,0 +1,56 @@
+#include "Frustum.h"
+
+#include <cmath>
+
+Frustum::Frustum()
+{
+    // An all-accepting frustum until update is called
+    for (auto& plane : planes) {
+        plane = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    }
+}
+
+Frustum::Frustum(const glm::mat4& viewProjection)
+{
+    update(viewProjection);
+}
+
+// extract the planes from projection * view (Gribb-Hartmann, glm matrices are column-major)
+void Frustum::update(const glm::mat4& viewProjection)
+{
+    const glm::mat4& m = viewProjection;
+    glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+    glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+    glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+    glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+    planes[0] = row3 + row0;  // left
+    planes[1] = row3 - row0;  // right
+    planes[2] = row3 + row1;  // bottom
+    planes[3] = row3 - row1;  // top
+    planes[4] = row3 + row2;  // near
+    planes[5] = row3 - row2;  // far
+
+    // Normalize so distances are comparable between planes
+    for (auto& plane : planes) {
+        float length = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+        if (length > 0.0f) {
+            plane = plane * (1.0f / length);
+        }
+    }
+}
+
+// check if an axis-aligned box is at least partly inside the frustum
+bool Frustum::intersectsBox(const glm::vec3& boxMin, const glm::vec3& boxMax) const
+{
+    for (const auto& plane : planes) {
+        // The box corner furthest along the plane normal
+        float x = plane.x >= 0.0f ? boxMax.x : boxMin.x;
+        float y = plane.y >= 0.0f ? boxMax.y : boxMin.y;
+        float z = plane.z >= 0.0f ? boxMax.z : boxMin.z;
+        if (plane.x * x + plane.y * y + plane.z * z + plane.w < 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,27 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+// View frustum as six planes, extracted from a projection * view matrix.
+// Used to skip maze chunks whose bounding boxes lie completely outside the view.
+class Frustum
+{
+public:
+    Frustum();
+    explicit Frustum(const glm::mat4& viewProjection);
+
+    // extract the planes from projection * view
+    void update(const glm::mat4& viewProjection);
+
+    // check if an axis-aligned box is at least partly inside the frustum
+    bool intersectsBox(const glm::vec3& boxMin, const glm::vec3& boxMax) const;
+
+private:
+    // plane (a, b, c, d): a point p is inside when a*p.x + b*p.y + c*p.z + d >= 0
+    glm::vec4 planes[6];
+};
+
+#endif
@@ -0,0 +1,161 @@
+#include "HeadlessContext.h"
+
+#include <EGL/eglext.h>
+#include <iostream>
+
+using namespace std;
+
+HeadlessContext::HeadlessContext()
+    : display(EGL_NO_DISPLAY), context(EGL_NO_CONTEXT), framebuffer(0), colorBuffer(0), depthBuffer(0),
+      width(0), height(0)
+{
+}
+
+HeadlessContext::~HeadlessContext()
+{
+    destroy();
+}
+
+// create the context and a width x height offscreen framebuffer, returns 0 on success
+int HeadlessContext::create(int width, int height)
+{
+    this->width = width;
+    this->height = height;
+
+    if (createContext() != 0) {
+        destroy();
+        return -1;
+    }
+
+    // GLEW built for GLX reports a missing X display under EGL even though the entry points load fine
+    glewExperimental = GL_TRUE;
+    GLenum err = glewInit();
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+    if (err == GLEW_ERROR_NO_GLX_DISPLAY) {
+        err = GLEW_OK;
+    }
+#endif
+    if (err != GLEW_OK) {
+        cout << "Failed to initialize GLEW: " << glewGetErrorString(err) << endl;
+        destroy();
+        return -1;
+    }
+
+    cout << "OpenGL Version: " << glGetString(GL_VERSION) << endl;
+    cout << "OpenGL Renderer: " << glGetString(GL_RENDERER) << endl;
+
+    if (createFramebuffer() != 0) {
+        destroy();
+        return -1;
+    }
+    return 0;
+}
+
+int HeadlessContext::createContext()
+{
+    // Prefer the surfaceless platform, which needs neither X nor a DRM device
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (getPlatformDisplay) {
+        display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    }
+    if (display == EGL_NO_DISPLAY) {
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+
+    EGLint major = 0;
+    EGLint minor = 0;
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)) {
+        cout << "Failed to initialize EGL" << endl;
+        display = EGL_NO_DISPLAY;
+        return -1;
+    }
+
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        cout << "EGL does not support desktop OpenGL" << endl;
+        return -1;
+    }
+
+    const EGLint configAttributes[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(display, configAttributes, &config, 1, &configCount) || configCount == 0) {
+        cout << "No EGL config for OpenGL rendering" << endl;
+        return -1;
+    }
+
+    // Same version and profile as the windowed build
+    const EGLint contextAttributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+    if (context == EGL_NO_CONTEXT) {
+        cout << "Failed to create an OpenGL 3.3 core context through EGL" << endl;
+        return -1;
+    }
+
+    // No surface at all: everything is drawn into the framebuffer object
+    if (!eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+        cout << "Failed to make the EGL context current (EGL_KHR_surfaceless_context missing?)" << endl;
+        return -1;
+    }
+    return 0;
+}
+
+int HeadlessContext::createFramebuffer()
+{
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+
+    glGenRenderbuffers(1, &colorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+
+    glGenRenderbuffers(1, &depthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        cout << "Offscreen framebuffer is incomplete" << endl;
+        return -1;
+    }
+
+    glViewport(0, 0, width, height);
+    return 0;
+}
+
+// make the offscreen framebuffer the render target
+void HeadlessContext::bind()
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glViewport(0, 0, width, height);
+}
+
+// release the framebuffer and the context
+void HeadlessContext::destroy()
+{
+    if (context != EGL_NO_CONTEXT) {
+        if (framebuffer) {
+            glDeleteFramebuffers(1, &framebuffer);
+            glDeleteRenderbuffers(1, &colorBuffer);
+            glDeleteRenderbuffers(1, &depthBuffer);
+            framebuffer = colorBuffer = depthBuffer = 0;
+        }
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(display, context);
+        context = EGL_NO_CONTEXT;
+    }
+    if (display != EGL_NO_DISPLAY) {
+        eglTerminate(display);
+        display = EGL_NO_DISPLAY;
+    }
+}
@@ -0,0 +1,43 @@
+#ifndef HEADLESSCONTEXT_H
+#define HEADLESSCONTEXT_H
+
+#pragma once
+
+#include <GL/glew.h>
+#include <EGL/egl.h>
+
+// OpenGL 3.3 core context without a window, for benchmarking on machines without a display.
+// The context is created through EGL on Mesa's surfaceless platform (llvmpipe when no GPU
+// is present) and rendering goes into a framebuffer object of a fixed size.
+class HeadlessContext
+{
+public:
+    HeadlessContext();
+    ~HeadlessContext();
+
+    // create the context and a width x height offscreen framebuffer, returns 0 on success
+    int create(int width, int height);
+
+    // release the framebuffer and the context
+    void destroy();
+
+    // make the offscreen framebuffer the render target
+    void bind();
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+private:
+    EGLDisplay display;
+    EGLContext context;
+    GLuint framebuffer;
+    GLuint colorBuffer;
+    GLuint depthBuffer;
+    int width;
+    int height;
+
+    int createContext();
+    int createFramebuffer();
+};
+
+#endif
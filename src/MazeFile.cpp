@@ -0,0 +1,169 @@
+#include "MazeFile.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+// the wall words are mapped as they are, so loading needs a little-endian host
+bool littleEndianHost()
+{
+    const uint64_t probe = 1;
+    unsigned char first;
+    memcpy(&first, &probe, 1);
+    return first == 1;
+}
+
+}
+
+MazeFile::MazeFile()
+    : mapping(nullptr), mappedBytes(0)
+{
+    memset(&header, 0, sizeof(header));
+}
+
+MazeFile::~MazeFile()
+{
+    close();
+}
+
+// map the file at path, returns false when it is missing or not a valid maze file
+bool MazeFile::open(const string& path)
+{
+    close();
+
+    if (!littleEndianHost()) {
+        cerr << "MazeFile: maze files can only be mapped on little-endian hosts" << endl;
+        return false;
+    }
+
+    int descriptor = ::open(path.c_str(), O_RDONLY);
+    if (descriptor < 0) {
+        cerr << "MazeFile: cannot open " << path << endl;
+        return false;
+    }
+
+    struct stat status;
+    if (fstat(descriptor, &status) != 0 || static_cast<size_t>(status.st_size) < sizeof(MazeFileHeader)) {
+        cerr << "MazeFile: " << path << " is too small for a maze file" << endl;
+        ::close(descriptor);
+        return false;
+    }
+    size_t fileBytes = static_cast<size_t>(status.st_size);
+
+    // Private and writable: pages are copied on write, the file itself is never changed
+    void* address = mmap(nullptr, fileBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, descriptor, 0);
+    ::close(descriptor);
+    if (address == MAP_FAILED) {
+        cerr << "MazeFile: cannot map " << path << endl;
+        return false;
+    }
+    mapping = address;
+    mappedBytes = fileBytes;
+    memcpy(&header, mapping, sizeof(header));
+
+    // Check the header against the file before anything reads the walls
+    const char* problem = nullptr;
+    if (memcmp(header.magic, mazeFileMagic, sizeof(mazeFileMagic)) != 0)
+        problem = "not a maze file";
+    else if (header.version != mazeFileVersion)
+        problem = "unsupported version";
+    else if (header.headerBytes != sizeof(MazeFileHeader) || header.flags != 0)
+        problem = "unsupported header";
+    else if (header.width == 0 || header.height == 0 || header.width > 0x7fffffff || header.height > 0x7fffffff)
+        problem = "invalid maze size";
+    else if (header.dataWords != WallGrid::wordCount(header.width, header.height))
+        problem = "wall data does not match the maze size";
+    else if (fileBytes < header.headerBytes + header.dataWords * sizeof(uint64_t))
+        problem = "file is truncated";
+
+    if (problem) {
+        cerr << "MazeFile: " << path << ": " << problem << endl;
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MazeFile::close()
+{
+    if (mapping) {
+        munmap(mapping, mappedBytes);
+        mapping = nullptr;
+        mappedBytes = 0;
+    }
+}
+
+// the mapped wall words, laid out like a WallGrid of the header's size
+uint64_t* MazeFile::getWords() const
+{
+    if (!mapping) {
+        return nullptr;
+    }
+    return reinterpret_cast<uint64_t*>(static_cast<char*>(mapping) + header.headerBytes);
+}
+
+// header for a maze of the given parameters
+MazeFileHeader MazeFile::makeHeader(int width, int height, uint64_t seed, uint32_t rngKind, uint32_t algorithm,
+                                    uint32_t tileSize, uint64_t mazeId)
+{
+    MazeFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, mazeFileMagic, sizeof(header.magic));
+    header.version = mazeFileVersion;
+    header.headerBytes = sizeof(MazeFileHeader);
+    header.width = width;
+    header.height = height;
+    header.seed = seed;
+    header.mazeId = mazeId;
+    header.rngKind = rngKind;
+    header.algorithm = algorithm;
+    header.dataWords = WallGrid::wordCount(width, height);
+    header.tileSize = tileSize;
+    return header;
+}
+
+// write the header and every word of walls, returns false on an I/O error
+bool MazeFile::write(const string& path, const MazeFileHeader& header, const WallGrid& walls)
+{
+    ofstream file(path, ios::binary | ios::trunc);
+    if (!file) {
+        cerr << "MazeFile: cannot open " << path << endl;
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    bool written = writeWords(file, walls.wordData(), walls.getWordCount());
+    file.close();
+    if (!written || !file) {
+        cerr << "MazeFile: write failed for " << path << endl;
+        return false;
+    }
+    return true;
+}
+
+// append words to a maze file in the file's byte order (little-endian)
+bool MazeFile::writeWords(ofstream& file, const uint64_t* words, size_t count)
+{
+    if (littleEndianHost()) {
+        file.write(reinterpret_cast<const char*>(words), static_cast<streamsize>(count * sizeof(uint64_t)));
+        return static_cast<bool>(file);
+    }
+
+    // Swap through a small buffer on big-endian hosts
+    uint64_t buffer[512];
+    for (size_t start = 0; start < count; start += 512) {
+        size_t chunk = min<size_t>(512, count - start);
+        for (size_t i = 0; i < chunk; i++) {
+            buffer[i] = __builtin_bswap64(words[start + i]);
+        }
+        file.write(reinterpret_cast<const char*>(buffer), static_cast<streamsize>(chunk * sizeof(uint64_t)));
+    }
+    return static_cast<bool>(file);
+}
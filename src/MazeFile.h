@@ -0,0 +1,77 @@
+#ifndef MAZEFILE_H
+#define MAZEFILE_H
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+#include "WallGrid.h"
+
+using namespace std;
+
+// On-disk maze: a 64-byte header followed by the wall words in WallGrid order (every row
+// of east/south bits, then the north and then the west boundary bits), without the
+// cache line padding of the in-memory grid. Words are stored little-endian.
+struct MazeFileHeader {
+    char magic[8];           // "MAZEGRD" and a terminating zero
+    uint32_t version;        // format version, see mazeFileVersion
+    uint32_t headerBytes;    // size of this header, the wall words start right after it
+    uint32_t width;
+    uint32_t height;
+    uint64_t seed;
+    uint64_t mazeId;         // MazeGrid::mazeId of seed, size, rng, algorithm and tile size
+    uint32_t rngKind;        // Rng::Kind
+    uint32_t algorithm;      // MazeGenerator::Algorithm
+    uint64_t dataWords;      // 64-bit wall words after the header
+    uint32_t flags;          // no flags are defined yet, must be 0
+    uint32_t tileSize;       // tile size of tiled generation, 0 when not tiled
+};
+
+static_assert(sizeof(MazeFileHeader) == 64, "the maze file header is 64 bytes");
+
+static const char mazeFileMagic[8] = { 'M', 'A', 'Z', 'E', 'G', 'R', 'D', 0 };
+static const uint32_t mazeFileVersion = 1;
+
+// A maze file mapped into memory.
+// Opening only maps the file and checks the header, so it takes the same time for any
+// maze size; the wall pages are read from disk the first time something touches them.
+// The mapping is private: walls changed in memory never reach the file.
+class MazeFile
+{
+public:
+    MazeFile();
+    ~MazeFile();
+
+    MazeFile(const MazeFile&) = delete;
+    MazeFile& operator=(const MazeFile&) = delete;
+
+    // map the file at path, returns false (with a message) when it is missing or not a valid maze file
+    bool open(const string& path);
+    void close();
+
+    bool isOpen() const { return mapping != nullptr; }
+    const MazeFileHeader& getHeader() const { return header; }
+
+    // the mapped wall words, laid out like a WallGrid of the header's size
+    uint64_t* getWords() const;
+
+    // header for a maze of the given parameters
+    static MazeFileHeader makeHeader(int width, int height, uint64_t seed, uint32_t rngKind, uint32_t algorithm,
+                                     uint32_t tileSize, uint64_t mazeId);
+
+    // write the header and every word of walls, returns false on an I/O error
+    static bool write(const string& path, const MazeFileHeader& header, const WallGrid& walls);
+
+    // append words to a maze file in the file's byte order, returns false on an I/O error
+    static bool writeWords(ofstream& file, const uint64_t* words, size_t count);
+
+private:
+    MazeFileHeader header;
+    void* mapping;
+    size_t mappedBytes;
+};
+
+#endif
@@ -0,0 +1,548 @@
+#include "MazeGenerator.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Direction tables in WallGrid order (N, S, W, E)
+const int dx[4] = { 0, 0, -1, 1 };
+const int dy[4] = { -1, 1, 0, 0 };
+
+// Set bits of each 4-bit direction mask, and the position of its n-th set bit
+const uint8_t bitCount[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+const uint8_t nthBit[16][4] = {
+    { 0, 0, 0, 0 }, { 0, 0, 0, 0 }, { 1, 0, 0, 0 }, { 0, 1, 0, 0 },
+    { 2, 0, 0, 0 }, { 0, 2, 0, 0 }, { 1, 2, 0, 0 }, { 0, 1, 2, 0 },
+    { 3, 0, 0, 0 }, { 0, 3, 0, 0 }, { 1, 3, 0, 0 }, { 0, 1, 3, 0 },
+    { 2, 3, 0, 0 }, { 0, 2, 3, 0 }, { 1, 2, 3, 0 }, { 0, 1, 2, 3 }
+};
+
+// random direction out of a non-empty mask
+inline int pickDirection(uint32_t mask, Rng& rng)
+{
+    return nthBit[mask][rng.bounded(bitCount[mask])];
+}
+
+// directions that stay inside a width x height grid from (x, y)
+inline uint32_t insideMask(int x, int y, int width, int height)
+{
+    return static_cast<uint32_t>(y > 0)
+         | static_cast<uint32_t>(y < height - 1) << 1
+         | static_cast<uint32_t>(x > 0) << 2
+         | static_cast<uint32_t>(x < width - 1) << 3;
+}
+
+// Randomized depth-first search.
+// Iterative and allocation free inside the loop: the stack holds packed cell indices, the
+// unvisited neighbours form a 4-bit mask and the carving direction is a table lookup.
+class DfsGenerator : public MazeGenerator
+{
+public:
+    Algorithm getAlgorithm() const override { return DFS; }
+
+    void generate(WallGrid& walls, Rng& rng) override
+    {
+        int width = walls.getWidth();
+        int height = walls.getHeight();
+        scratchBytes = 0;
+        if (width <= 0 || height <= 0) {
+            return;
+        }
+
+        // Visited bits over the grid with a one cell border that counts as visited,
+        // so the neighbour tests need no bounds checks
+        const size_t paddedWidth = static_cast<size_t>(width) + 2;
+        const size_t paddedCells = paddedWidth * (static_cast<size_t>(height) + 2);
+        vector<uint64_t> visitedBits((paddedCells + 63) / 64, 0);
+        auto isVisited = [&](size_t cell) { return (visitedBits[cell >> 6] >> (cell & 63)) & 1u; };
+        auto markVisited = [&](size_t cell) { visitedBits[cell >> 6] |= uint64_t(1) << (cell & 63); };
+        for (size_t x = 0; x < paddedWidth; x++) {
+            markVisited(x);
+            markVisited(paddedCells - 1 - x);
+        }
+        for (size_t y = 1; y <= static_cast<size_t>(height); y++) {
+            markVisited(y * paddedWidth);
+            markVisited(y * paddedWidth + paddedWidth - 1);
+        }
+
+        // Stack of padded cell indices; a cell is pushed at most once, so the reserve is never exceeded
+        // (reserved rather than sized, so only the depth actually reached gets touched)
+        vector<uint32_t> stack;
+        stack.reserve(static_cast<size_t>(width) * height);
+        size_t maxDepth = 0;
+
+        const ptrdiff_t step[4] = { -static_cast<ptrdiff_t>(paddedWidth), static_cast<ptrdiff_t>(paddedWidth), -1, 1 };
+
+        // Start in the top-left corner
+        int x = 0;
+        int y = 0;
+        size_t cell = paddedWidth + 1;
+        markVisited(cell);
+        stack.push_back(static_cast<uint32_t>(cell));
+
+        // Keep carving passages while there are cells to visit
+        while (!stack.empty()) {
+            uint32_t mask = (isVisited(cell + step[0]) ^ 1u)
+                          | (isVisited(cell + step[1]) ^ 1u) << 1
+                          | (isVisited(cell + step[2]) ^ 1u) << 2
+                          | (isVisited(cell + step[3]) ^ 1u) << 3;
+
+            // If all neighbors are visited, backtrack
+            if (mask == 0) {
+                maxDepth = max(maxDepth, stack.size());
+                stack.pop_back();
+                if (stack.empty()) {
+                    break;
+                }
+                cell = stack.back();
+                x = static_cast<int>(cell % paddedWidth) - 1;
+                y = static_cast<int>(cell / paddedWidth) - 1;
+                continue;
+            }
+
+            // Choose a random unvisited neighbor (same draw as picking from a list in N, S, W, E order)
+            int direction = pickDirection(mask, rng);
+
+            // Remove the wall between current and chosen cells (shared walls are stored once)
+            walls.removeWall(x, y, static_cast<WallGrid::Direction>(direction));
+
+            cell += step[direction];
+            x += dx[direction];
+            y += dy[direction];
+            markVisited(cell);
+            stack.push_back(static_cast<uint32_t>(cell));
+        }
+
+        scratchBytes = visitedBits.size() * sizeof(uint64_t) + maxDepth * sizeof(uint32_t);
+    }
+};
+
+// Randomized Kruskal: every interior edge in random order, opened when it joins two
+// different trees (union-find with path halving and union by rank).
+class KruskalGenerator : public MazeGenerator
+{
+public:
+    Algorithm getAlgorithm() const override { return KRUSKAL; }
+
+    void generate(WallGrid& walls, Rng& rng) override
+    {
+        int width = walls.getWidth();
+        int height = walls.getHeight();
+        size_t cellCount = static_cast<size_t>(width) * height;
+        scratchBytes = 0;
+        if (cellCount == 0) {
+            return;
+        }
+
+        // Edges packed as cell * 2 + (0 = east, 1 = south)
+        vector<uint32_t> edges;
+        edges.reserve(2 * cellCount);
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                uint32_t cell = static_cast<uint32_t>(y) * width + x;
+                if (x < width - 1)
+                    edges.push_back(cell * 2);
+                if (y < height - 1)
+                    edges.push_back(cell * 2 + 1);
+            }
+        }
+
+        // Fisher-Yates shuffle
+        for (size_t i = edges.size(); i > 1; i--) {
+            swap(edges[i - 1], edges[rng.bounded(static_cast<uint32_t>(i))]);
+        }
+
+        vector<uint32_t> parent(cellCount);
+        vector<uint8_t> rank(cellCount, 0);
+        for (size_t i = 0; i < cellCount; i++) {
+            parent[i] = static_cast<uint32_t>(i);
+        }
+        auto find = [&](uint32_t cell) {
+            while (parent[cell] != cell) {
+                parent[cell] = parent[parent[cell]];
+                cell = parent[cell];
+            }
+            return cell;
+        };
+
+        size_t joins = 0;
+        for (uint32_t edge : edges) {
+            uint32_t a = edge >> 1;
+            uint32_t b = (edge & 1) ? a + width : a + 1;
+            uint32_t rootA = find(a);
+            uint32_t rootB = find(b);
+            if (rootA == rootB) {
+                continue;
+            }
+            if (rank[rootA] < rank[rootB])
+                swap(rootA, rootB);
+            parent[rootB] = rootA;
+            if (rank[rootA] == rank[rootB])
+                rank[rootA]++;
+
+            walls.removeWall(a % width, a / width, (edge & 1) ? WallGrid::SOUTH : WallGrid::EAST);
+
+            // A spanning tree has cellCount - 1 edges
+            if (++joins == cellCount - 1) {
+                break;
+            }
+        }
+
+        scratchBytes = edges.capacity() * sizeof(uint32_t) + parent.size() * sizeof(uint32_t) + rank.size();
+    }
+};
+
+// Wilson: loop-erased random walks from every cell not yet in the tree until they hit it.
+// Produces a uniformly random spanning tree; slow while the tree is still small.
+class WilsonGenerator : public MazeGenerator
+{
+public:
+    Algorithm getAlgorithm() const override { return WILSON; }
+
+    void generate(WallGrid& walls, Rng& rng) override
+    {
+        int width = walls.getWidth();
+        int height = walls.getHeight();
+        size_t cellCount = static_cast<size_t>(width) * height;
+        scratchBytes = 0;
+        if (cellCount == 0) {
+            return;
+        }
+
+        vector<uint64_t> inTree((cellCount + 63) / 64, 0);
+        vector<uint8_t> exitDirection(cellCount, 0);   // last direction the walk left each cell by
+        auto isInTree = [&](size_t cell) { return (inTree[cell >> 6] >> (cell & 63)) & 1u; };
+        auto addToTree = [&](size_t cell) { inTree[cell >> 6] |= uint64_t(1) << (cell & 63); };
+        const ptrdiff_t step[4] = { -static_cast<ptrdiff_t>(width), width, -1, 1 };
+
+        addToTree(rng.bounded(static_cast<uint32_t>(cellCount)));
+
+        for (size_t start = 0; start < cellCount; start++) {
+            if (isInTree(start)) {
+                continue;
+            }
+
+            // Random walk until the tree is hit; overwriting the exit direction erases loops
+            int startX = static_cast<int>(start % width);
+            int startY = static_cast<int>(start / width);
+            int x = startX;
+            int y = startY;
+            size_t cell = start;
+            while (!isInTree(cell)) {
+                int direction = pickDirection(insideMask(x, y, width, height), rng);
+                exitDirection[cell] = static_cast<uint8_t>(direction);
+                cell += step[direction];
+                x += dx[direction];
+                y += dy[direction];
+            }
+
+            // Follow the loop-free path again and add it to the tree
+            x = startX;
+            y = startY;
+            cell = start;
+            while (!isInTree(cell)) {
+                int direction = exitDirection[cell];
+                addToTree(cell);
+                walls.removeWall(x, y, static_cast<WallGrid::Direction>(direction));
+                cell += step[direction];
+                x += dx[direction];
+                y += dy[direction];
+            }
+        }
+
+        scratchBytes = inTree.size() * sizeof(uint64_t) + exitDirection.size();
+    }
+};
+
+// Randomized Prim: grows one tree by connecting a random frontier cell to a random
+// neighbour already in the maze.
+class PrimGenerator : public MazeGenerator
+{
+public:
+    Algorithm getAlgorithm() const override { return PRIM; }
+
+    void generate(WallGrid& walls, Rng& rng) override
+    {
+        int width = walls.getWidth();
+        int height = walls.getHeight();
+        size_t cellCount = static_cast<size_t>(width) * height;
+        scratchBytes = 0;
+        if (cellCount == 0) {
+            return;
+        }
+
+        enum : uint8_t { OUTSIDE = 0, FRONTIER = 1, INSIDE = 2 };
+        vector<uint8_t> state(cellCount, OUTSIDE);
+        vector<uint32_t> frontier;
+        size_t maxFrontier = 0;
+        const ptrdiff_t step[4] = { -static_cast<ptrdiff_t>(width), width, -1, 1 };
+
+        auto addToMaze = [&](size_t cell, int x, int y) {
+            state[cell] = INSIDE;
+            uint32_t mask = insideMask(x, y, width, height);
+            for (int direction = 0; direction < 4; direction++) {
+                size_t neighbour = cell + step[direction];
+                if ((mask >> direction & 1u) && state[neighbour] == OUTSIDE) {
+                    state[neighbour] = FRONTIER;
+                    frontier.push_back(static_cast<uint32_t>(neighbour));
+                }
+            }
+            maxFrontier = max(maxFrontier, frontier.size());
+        };
+
+        size_t start = rng.bounded(static_cast<uint32_t>(cellCount));
+        addToMaze(start, static_cast<int>(start % width), static_cast<int>(start / width));
+
+        while (!frontier.empty()) {
+            // Take a random frontier cell (swap with the last one and pop)
+            size_t index = rng.bounded(static_cast<uint32_t>(frontier.size()));
+            size_t cell = frontier[index];
+            frontier[index] = frontier.back();
+            frontier.pop_back();
+
+            int x = static_cast<int>(cell % width);
+            int y = static_cast<int>(cell / width);
+
+            // Connect it to a random neighbour inside the maze
+            uint32_t inside = insideMask(x, y, width, height);
+            uint32_t mask = 0;
+            for (int direction = 0; direction < 4; direction++) {
+                if ((inside >> direction & 1u) && state[cell + step[direction]] == INSIDE)
+                    mask |= 1u << direction;
+            }
+            walls.removeWall(x, y, static_cast<WallGrid::Direction>(pickDirection(mask, rng)));
+
+            addToMaze(cell, x, y);
+        }
+
+        scratchBytes = state.size() + maxFrontier * sizeof(uint32_t);
+    }
+};
+
+// Eller: one row at a time, keeping only the set of every cell in the current row.
+// Neighbours in different sets are joined at random, every set continues down at
+// least once, and the last row joins everything that is left.
+class EllerGenerator : public MazeGenerator
+{
+public:
+    Algorithm getAlgorithm() const override { return ELLER; }
+
+    void generate(WallGrid& walls, Rng& rng) override
+    {
+        int width = walls.getWidth();
+        int height = walls.getHeight();
+        scratchBytes = 0;
+        if (width <= 0 || height <= 0) {
+            return;
+        }
+
+        EllerRows rows(width);
+        for (int y = 0; y < height; y++) {
+            rows.carveRow(walls.rowData(y), y == height - 1, rng);
+        }
+        scratchBytes = rows.getScratchBytes();
+    }
+};
+
+// Binary tree: every cell opens its north or its west wall. Strong diagonal bias,
+// open corridors along the north row and the west column.
+class BinaryTreeGenerator : public MazeGenerator
+{
+public:
+    Algorithm getAlgorithm() const override { return BINARY_TREE; }
+
+    void generate(WallGrid& walls, Rng& rng) override
+    {
+        scratchBytes = 0;
+        for (int y = 0; y < walls.getHeight(); y++) {
+            for (int x = 0; x < walls.getWidth(); x++) {
+                bool canGoNorth = y > 0;
+                bool canGoWest = x > 0;
+                if (canGoNorth && canGoWest) {
+                    walls.removeWall(x, y, rng.bounded(2) == 0 ? WallGrid::NORTH : WallGrid::WEST);
+                }
+                else if (canGoNorth) {
+                    walls.removeWall(x, y, WallGrid::NORTH);
+                }
+                else if (canGoWest) {
+                    walls.removeWall(x, y, WallGrid::WEST);
+                }
+            }
+        }
+    }
+};
+
+// Sidewinder: each row is cut into runs of eastward passages and every run opens
+// north from one random cell of it. The north row is one open corridor.
+class SidewinderGenerator : public MazeGenerator
+{
+public:
+    Algorithm getAlgorithm() const override { return SIDEWINDER; }
+
+    void generate(WallGrid& walls, Rng& rng) override
+    {
+        int width = walls.getWidth();
+        int height = walls.getHeight();
+        scratchBytes = 0;
+        for (int y = 0; y < height; y++) {
+            int runStart = 0;
+            for (int x = 0; x < width; x++) {
+                if (y == 0) {
+                    if (x < width - 1)
+                        walls.removeWall(x, y, WallGrid::EAST);
+                    continue;
+                }
+
+                bool closeRun = x == width - 1 || rng.bounded(2) == 0;
+                if (!closeRun) {
+                    walls.removeWall(x, y, WallGrid::EAST);
+                    continue;
+                }
+                int northCell = runStart + static_cast<int>(rng.bounded(static_cast<uint32_t>(x - runStart + 1)));
+                walls.removeWall(northCell, y, WallGrid::NORTH);
+                runStart = x + 1;
+            }
+        }
+    }
+};
+
+const char* algorithmNames[MazeGenerator::ALGORITHM_COUNT] = {
+    "dfs", "kruskal", "wilson", "prim", "eller", "binary-tree", "sidewinder"
+};
+
+}
+
+EllerRows::EllerRows(int width)
+    : width(width), rowIndex(0), parent(width), label(width), openAbove(width, 0), firstWithLabel(width),
+      labelStamp(width, 0), remaining(width), wentDown(width)
+{
+}
+
+uint32_t EllerRows::find(uint32_t column)
+{
+    while (parent[column] != column) {
+        parent[column] = parent[parent[column]];
+        column = parent[column];
+    }
+    return column;
+}
+
+// carve the next row into a buffer in the WallGrid row format
+void EllerRows::carveRow(uint64_t* row, bool lastRow, Rng& rng)
+{
+    auto clearBit = [row](int x, unsigned bit) { row[x >> 5] &= ~(uint64_t(1) << ((x & 31) * 2 + bit)); };
+    uint32_t y = rowIndex++;
+
+    // Cells opened from above keep their set; the others start a set of their own
+    for (int x = 0; x < width; x++) {
+        parent[x] = x;
+        if (!openAbove[x]) {
+            continue;
+        }
+        uint32_t setLabel = label[x];
+        if (labelStamp[setLabel] == y) {
+            parent[x] = find(firstWithLabel[setLabel]);
+        }
+        else {
+            labelStamp[setLabel] = y;
+            firstWithLabel[setLabel] = x;
+        }
+    }
+
+    // Join neighbours from different sets (always on the last row)
+    for (int x = 0; x < width - 1; x++) {
+        uint32_t left = find(x);
+        uint32_t right = find(x + 1);
+        if (left != right && (lastRow || rng.bounded(2) == 0)) {
+            parent[max(left, right)] = min(left, right);
+            clearBit(x, 0);
+        }
+    }
+    if (lastRow) {
+        return;
+    }
+
+    // Open cells downward at random, making sure every set continues at least once
+    for (int x = 0; x < width; x++) {
+        uint32_t root = find(x);
+        label[x] = root;
+        remaining[root] = 0;
+        wentDown[root] = 0;
+    }
+    for (int x = 0; x < width; x++) {
+        remaining[label[x]]++;
+    }
+    for (int x = 0; x < width; x++) {
+        uint32_t root = label[x];
+        bool down = rng.bounded(2) == 0;
+        if (--remaining[root] == 0 && !wentDown[root]) {
+            down = true;
+        }
+        wentDown[root] |= down;
+        openAbove[x] = down;
+        if (down) {
+            clearBit(x, 1);
+        }
+    }
+}
+
+// scratch memory of the row state, in bytes
+size_t EllerRows::getScratchBytes() const
+{
+    return static_cast<size_t>(width) * (5 * sizeof(uint32_t) + 2 * sizeof(uint8_t));
+}
+
+MazeGenerator::MazeGenerator()
+    : scratchBytes(0)
+{
+}
+
+MazeGenerator::~MazeGenerator()
+{
+}
+
+// create a generator for the algorithm, owned by the caller
+MazeGenerator* MazeGenerator::create(Algorithm algorithm)
+{
+    switch (algorithm) {
+    case KRUSKAL:
+        return new KruskalGenerator();
+    case WILSON:
+        return new WilsonGenerator();
+    case PRIM:
+        return new PrimGenerator();
+    case ELLER:
+        return new EllerGenerator();
+    case BINARY_TREE:
+        return new BinaryTreeGenerator();
+    case SIDEWINDER:
+        return new SidewinderGenerator();
+    case DFS:
+    default:
+        return new DfsGenerator();
+    }
+}
+
+// name of the algorithm ("dfs", "kruskal", ...)
+const char* MazeGenerator::getName(Algorithm algorithm)
+{
+    if (algorithm < 0 || algorithm >= ALGORITHM_COUNT) {
+        return "unknown";
+    }
+    return algorithmNames[algorithm];
+}
+
+// algorithm with the given name, false when there is none
+bool MazeGenerator::findAlgorithm(const string& name, Algorithm& algorithm)
+{
+    for (int i = 0; i < ALGORITHM_COUNT; i++) {
+        if (name == algorithmNames[i]) {
+            algorithm = static_cast<Algorithm>(i);
+            return true;
+        }
+    }
+    return false;
+}
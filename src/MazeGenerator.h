@@ -0,0 +1,88 @@
+#ifndef MAZEGENERATOR_H
+#define MAZEGENERATOR_H
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Rng.h"
+#include "WallGrid.h"
+
+using namespace std;
+
+// Interface of the maze generation algorithms.
+// A generator carves a perfect maze (exactly one path between any two cells) into a
+// grid that has every wall present, drawing all randomness from the given Rng so the
+// result is a pure function of the seed. The algorithms differ a lot in speed, scratch
+// memory and the look of the maze, so each reports the scratch memory it used.
+class MazeGenerator
+{
+public:
+    // Available algorithms (the numbering is part of the maze ID, append only)
+    enum Algorithm {
+        DFS = 0,           // randomized depth-first search (recursive backtracker)
+        KRUSKAL = 1,       // randomized Kruskal with union-find
+        WILSON = 2,        // Wilson's loop-erased random walks (uniform spanning tree)
+        PRIM = 3,          // randomized Prim, random frontier cell
+        ELLER = 4,         // Eller's row-by-row sets, scratch memory O(width)
+        BINARY_TREE = 5,   // carve north or west from every cell, no scratch memory
+        SIDEWINDER = 6,    // runs along each row closed to the north, no scratch memory
+        ALGORITHM_COUNT = 7
+    };
+
+    MazeGenerator();
+    virtual ~MazeGenerator();
+
+    // carve the maze into walls, which must have every wall present
+    virtual void generate(WallGrid& walls, Rng& rng) = 0;
+
+    virtual Algorithm getAlgorithm() const = 0;
+
+    // scratch memory touched by the last generate, in bytes (the wall grid itself excluded)
+    size_t getScratchBytes() const { return scratchBytes; }
+
+    // create a generator for the algorithm, owned by the caller
+    static MazeGenerator* create(Algorithm algorithm);
+
+    // name of the algorithm ("dfs", "kruskal", ...), and the reverse lookup
+    static const char* getName(Algorithm algorithm);
+    static bool findAlgorithm(const string& name, Algorithm& algorithm);
+
+protected:
+    size_t scratchBytes;
+};
+
+// Eller's algorithm one row at a time, with state for a single row only (O(width) memory).
+// Rows are carved top to bottom into buffers in the WallGrid row format that start with every
+// wall present; the in-memory ELLER generator and the streaming file writer both use it, so
+// they produce the same maze for the same seed.
+class EllerRows
+{
+public:
+    explicit EllerRows(int width);
+
+    // carve the next row: clears east bits of joined neighbours and south bits of cells that
+    // continue down; the last row joins every remaining set and opens nothing downward
+    void carveRow(uint64_t* row, bool lastRow, Rng& rng);
+
+    // scratch memory of the row state, in bytes
+    size_t getScratchBytes() const;
+
+private:
+    int width;
+    uint32_t rowIndex;
+    vector<uint32_t> parent;           // union-find parent within the row
+    vector<uint32_t> label;            // set label carried from the row above
+    vector<uint8_t> openAbove;         // cell was opened from the row above
+    vector<uint32_t> firstWithLabel;   // first column seen with each label this row
+    vector<uint32_t> labelStamp;       // row a label was last seen in, never needs clearing
+    vector<uint32_t> remaining;        // cells of each set not yet given a chance to go down
+    vector<uint8_t> wentDown;          // set already continues in the next row
+
+    uint32_t find(uint32_t column);
+};
+
+#endif
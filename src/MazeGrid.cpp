@@ -0,0 +1,416 @@
+#include "MazeGrid.h"
+#include "CircleCollider.h"
+#include "CollisionBatch.h"
+#include "MazeFile.h"
+#include "TiledGenerator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+
+// Bumped whenever a change to the generator alters the mazes a seed produces, so old IDs stop matching
+static const uint64_t generatorVersion = 1;
+
+MazeGrid::MazeGrid()
+    : MazeGrid(0, 0, uint64_t(0), Rng::XOSHIRO256)
+{
+}
+
+MazeGrid::MazeGrid(int width, int height, float cellSize, float originX, float originZ)
+    : MazeGrid(width, height, randomSeed(), Rng::XOSHIRO256, cellSize, originX, originZ)
+{
+}
+
+MazeGrid::MazeGrid(int width, int height, uint64_t seed, Rng::Kind rngKind, float cellSize, float originX, float originZ)
+    : width(width), height(height), cellSize(cellSize), originX(originX), originZ(originZ),
+      seedValue(seed), rng(seed, rngKind), algorithm(MazeGenerator::DFS), tileSize(0), threadCount(0),
+      lastScratchBytes(0)
+{
+    // Initialize the walls grid (all walls are initially present)
+    walls.resize(width, height);
+}
+
+// generate a maze on a worker thread; the result is handed to the maze constructor
+future<MazeGrid> MazeGrid::generateAsync(int width, int height, uint64_t seed, float cellSize,
+                                         MazeGenerator::Algorithm algorithm)
+{
+    return async(launch::async, [width, height, seed, cellSize, algorithm]() {
+        MazeGrid grid(width, height, seed, Rng::XOSHIRO256, cellSize);
+        grid.setAlgorithm(algorithm);
+        grid.generateMaze();
+        return grid;
+    });
+}
+
+// a fresh seed for when no particular maze is asked for
+uint64_t MazeGrid::randomSeed()
+{
+    random_device device;
+    uint64_t entropy = (static_cast<uint64_t>(device()) << 32) | device();
+    return Rng::mix(entropy ^ static_cast<uint64_t>(chrono::steady_clock::now().time_since_epoch().count()));
+}
+
+// identifier of the maze a seed, size and generator produce
+// (the algorithm and tile size go above the bits of the generator version, so untiled DFS mazes keep their IDs)
+uint64_t MazeGrid::mazeId(uint64_t seed, int width, int height, Rng::Kind rngKind, MazeGenerator::Algorithm algorithm,
+                          int tileSize)
+{
+    uint64_t id = Rng::mix(seed);
+    id = Rng::mix(id ^ ((static_cast<uint64_t>(static_cast<uint32_t>(width)) << 32) | static_cast<uint32_t>(height)));
+    id = Rng::mix(id ^ ((static_cast<uint64_t>(static_cast<uint32_t>(tileSize)) << 24) | (static_cast<uint64_t>(algorithm) << 16) |
+                        (generatorVersion << 8) | static_cast<uint64_t>(rngKind)));
+    return id;
+}
+
+uint64_t MazeGrid::getMazeId() const
+{
+    return mazeId(seedValue, width, height, rng.getKind(), algorithm, tileSize);
+}
+
+// select the seed (and generator) used by the next generateMaze
+void MazeGrid::seed(uint64_t value, Rng::Kind rngKind)
+{
+    seedValue = value;
+    rng.seed(value, rngKind);
+}
+
+// select the algorithm used by the next generateMaze
+void MazeGrid::setAlgorithm(MazeGenerator::Algorithm value)
+{
+    algorithm = value;
+}
+
+// generate in tiles on worker threads, tileSize 0 generates the whole grid in one piece
+void MazeGrid::setTiling(int tileSize, int threadCount)
+{
+    this->tileSize = tileSize > 0 ? TiledGenerator::roundTileSize(tileSize) : 0;
+    this->threadCount = threadCount;
+}
+
+// replace the maze with the one in a maze file, the walls are read from disk as they are touched
+bool MazeGrid::loadFile(const string& path)
+{
+    shared_ptr<MazeFile> file = make_shared<MazeFile>();
+    if (!file->open(path)) {
+        return false;
+    }
+
+    const MazeFileHeader& header = file->getHeader();
+    if (header.rngKind > Rng::PCG32 || header.algorithm >= MazeGenerator::ALGORITHM_COUNT || header.tileSize % 32 != 0) {
+        cout << "Maze file " << path << " was written with an unknown generator" << endl;
+        return false;
+    }
+
+    width = static_cast<int>(header.width);
+    height = static_cast<int>(header.height);
+    seed(header.seed, static_cast<Rng::Kind>(header.rngKind));
+    algorithm = static_cast<MazeGenerator::Algorithm>(header.algorithm);
+    tileSize = static_cast<int>(header.tileSize);
+    lastScratchBytes = 0;
+    pathCells.clear();
+    exitField.clear();
+    pathIndex.clear();
+    chunkGraph.clear();
+    flowFields.clear();
+
+    // The grid keeps the mapping alive
+    walls.attach(file->getWords(), width, height, file);
+
+    if (getMazeId() != header.mazeId) {
+        cout << "Maze file " << path << " comes from another generator version, its seed no longer reproduces it" << endl;
+    }
+    return true;
+}
+
+// write the maze to a maze file, returns false on an I/O error
+bool MazeGrid::saveFile(const string& path) const
+{
+    MazeFileHeader header = MazeFile::makeHeader(width, height, seedValue, rng.getKind(), algorithm, tileSize, getMazeId());
+    return MazeFile::write(path, header, walls);
+}
+
+// move cell (0, 0) to the given world position
+void MazeGrid::setOrigin(float x, float z)
+{
+    originX = x;
+    originZ = z;
+}
+
+// generate the maze with the selected algorithm
+void MazeGrid::generateMaze()
+{
+    // Every generation starts from the seed, so the walls depend on nothing else
+    rng.seed(seedValue);
+
+    // Initialize the walls to be present
+    walls.fill(true);
+    exitField.clear();
+    pathIndex.clear();
+    chunkGraph.clear();
+    flowFields.clear();
+    if (width <= 0 || height <= 0) {
+        return;
+    }
+
+    if (tileSize > 0) {
+        TiledGenerator generator(algorithm, tileSize, threadCount);
+        generator.generate(walls, seedValue, rng);
+        lastScratchBytes = generator.getScratchBytes();
+    }
+    else {
+        MazeGenerator* generator = MazeGenerator::create(algorithm);
+        generator->generate(walls, rng);
+        lastScratchBytes = generator->getScratchBytes();
+        delete generator;
+    }
+
+    // Make sure entrance and exit are clear
+    walls.removeWall(0, 0, WallGrid::NORTH); // Clear entrance
+    walls.removeWall(width-1, height-1, WallGrid::SOUTH); // Clear exit
+}
+
+// check if the position (world x, z) collides with the maze
+bool MazeGrid::checkCollision(float x, float z) const
+{
+    // Reduce collision buffer
+    const float collisionBuffer = 0.12f;
+    
+    // Check if the position is outside the maze
+    if (x < originX + collisionBuffer || 
+        x > originX + (width * cellSize) - collisionBuffer ||
+        z < originZ + collisionBuffer || 
+        z > originZ + (height * cellSize) - collisionBuffer) {
+        return true; // Collision with the maze boundaries
+    }
+
+    // Convert the position to maze coordinates - handle edge cases better
+    int cellX = static_cast<int>((x - originX) / cellSize);
+    int cellZ = static_cast<int>((z - originZ) / cellSize);
+    
+    // Ensure we're within valid cell range
+    if (cellX < 0) cellX = 0;
+    if (cellX >= width) cellX = width - 1;
+    if (cellZ < 0) cellZ = 0;
+    if (cellZ >= height) cellZ = height - 1;
+    
+    // Get local position in the cell with better precision
+    float localX = (x - originX) - (cellX * cellSize);
+    float localZ = (z - originZ) - (cellZ * cellSize);
+ 
+    // Check collisions with current cell walls
+    bool collision = false;
+    
+    // North wall collision
+    if (walls.hasWall(cellX, cellZ, WallGrid::NORTH) && localZ < collisionBuffer) {
+        collision = true;
+    }
+    // South wall collision
+    else if (walls.hasWall(cellX, cellZ, WallGrid::SOUTH) && localZ > cellSize - collisionBuffer) {
+        collision = true;
+    }
+    // West wall collision
+    else if (walls.hasWall(cellX, cellZ, WallGrid::WEST) && localX < collisionBuffer) {
+        collision = true;
+    }
+    // East wall collision
+    else if (walls.hasWall(cellX, cellZ, WallGrid::EAST) && localX > cellSize - collisionBuffer) {
+        collision = true;
+    }
+    
+    // Check for corner cases - when we're near cell boundaries
+    // This prevents getting stuck at cell corners
+    if (localX < collisionBuffer && localZ < collisionBuffer) {
+        // Near northwest corner - check diagonal cell if it exists
+        if (cellX > 0 && cellZ > 0) {
+            if (walls.hasWall(cellX-1, cellZ-1, WallGrid::SOUTH) || walls.hasWall(cellX-1, cellZ-1, WallGrid::EAST)) {
+                collision = true;
+            }
+        }
+    }
+    else if (localX > cellSize - collisionBuffer && localZ < collisionBuffer) {
+        // Near northeast corner
+        if (cellX < width-1 && cellZ > 0) {
+            if (walls.hasWall(cellX+1, cellZ-1, WallGrid::SOUTH) || walls.hasWall(cellX+1, cellZ-1, WallGrid::WEST)) {
+                collision = true;
+            }
+        }
+    }
+    
+    return collision;
+}
+
+// move a circle by (moveX, moveZ), stopping at walls and sliding along them
+bool MazeGrid::moveCircle(float& x, float& z, float moveX, float moveZ, float radius) const
+{
+    // The collider works in cells relative to the origin
+    float localX = (x - originX) / cellSize;
+    float localZ = (z - originZ) / cellSize;
+    bool touched = CircleCollider::move(walls, localX, localZ, moveX / cellSize, moveZ / cellSize, radius / cellSize);
+    x = originX + localX * cellSize;
+    z = originZ + localZ * cellSize;
+    return touched;
+}
+
+// moveCircle for count circles in place
+size_t MazeGrid::moveCircles(float* xs, float* zs, const float* moveXs, const float* moveZs, float radius,
+                             size_t count) const
+{
+    size_t touched = 0;
+    for (size_t i = 0; i < count; i++) {
+        touched += moveCircle(xs[i], zs[i], moveXs[i], moveZs[i], radius);
+    }
+    return touched;
+}
+
+// push count circles out of the walls they overlap
+size_t MazeGrid::resolveCircles(const float* xs, const float* zs, const float* radii, size_t count,
+                                float* outXs, float* outZs, uint8_t* hitBits) const
+{
+    return CollisionBatch::resolve(walls, originX, originZ, cellSize, xs, zs, radii, count, outXs, outZs, hitBits);
+}
+
+// cell under the position (world x, z), false when it lies outside the maze
+bool MazeGrid::worldToCell(float x, float z, int& cellX, int& cellY) const
+{
+    float localX = (x - originX) / cellSize;
+    float localZ = (z - originZ) / cellSize;
+    if (localX < 0.0f || localZ < 0.0f || localX >= width || localZ >= height) {
+        return false;
+    }
+    cellX = min(static_cast<int>(localX), width - 1);
+    cellY = min(static_cast<int>(localZ), height - 1);
+    return true;
+}
+
+// add or remove a wall after generation; keeps the exit distance field up to date
+void MazeGrid::setWall(int x, int y, WallGrid::Direction direction, bool present)
+{
+    if (walls.hasWall(x, y, direction) == present) {
+        return;
+    }
+    walls.setWall(x, y, direction, present);
+    if (exitField.isBuilt()) {
+        exitField.wallChanged(walls, x, y, direction);
+    }
+    pathIndex.clear();
+    chunkGraph.clear();
+    flowFields.clear();
+}
+
+// paths for a batch of requests, one search per distinct goal
+const PathBatch& MazeGrid::solvePaths(const PathRequest* requests, size_t count)
+{
+    pathBatch.solve(walls, requests, count);
+    return pathBatch;
+}
+
+// flow field toward a target cell, from the cache or one search
+const uint8_t* MazeGrid::getFlowField(int targetX, int targetY)
+{
+    if (targetX < 0 || targetX >= width || targetY < 0 || targetY >= height) {
+        return nullptr;
+    }
+    return flowFields.getField(walls, static_cast<uint32_t>(targetY) * width + targetX);
+}
+
+// distances from every cell to the exit cell
+void MazeGrid::buildExitField()
+{
+    exitField.build(walls, width - 1, height - 1);
+}
+
+// index a perfect maze for path queries
+bool MazeGrid::buildPathIndex()
+{
+    return pathIndex.build(walls);
+}
+
+// abstract graph over chunks for hierarchical path finding
+void MazeGrid::buildChunkGraph(int chunkSize)
+{
+    chunkGraph.build(walls, chunkSize);
+}
+
+// path lengths between pairs of cells, from the path index or by searching
+void MazeGrid::pathLengths(const uint32_t* from, const uint32_t* to, size_t count, uint32_t* lengths)
+{
+    if (pathIndex.isBuilt()) {
+        pathIndex.pathLengths(from, to, count, lengths);
+        return;
+    }
+
+    size_t cellCount = static_cast<size_t>(width) * height;
+    vector<pair<int, int>> path;
+    for (size_t i = 0; i < count; i++) {
+        lengths[i] = MazeTree::unreachable;
+        if (from[i] < cellCount && to[i] < cellCount &&
+            findPath(from[i] % width, from[i] / width, to[i] % width, to[i] / width, path)) {
+            lengths[i] = static_cast<uint32_t>(path.size() - 1);
+        }
+    }
+}
+
+// path between two cells, from the path index, over the chunk graph or by search
+bool MazeGrid::findPath(int startX, int startY, int endX, int endY, vector<pair<int, int>>& path)
+{
+    if (pathIndex.isBuilt()) {
+        return pathIndex.findPath(static_cast<uint32_t>(startY * width + startX),
+                                  static_cast<uint32_t>(endY * width + endX), path);
+    }
+    if (chunkGraph.isBuilt()) {
+        return chunkGraph.findPath(walls, startX, startY, endX, endY, path);
+    }
+    return solver.findPath(walls, startX, startY, endX, endY, path);
+}
+
+// direction of the first step toward the exit from the position (world x, z)
+bool MazeGrid::exitDirection(float x, float z, WallGrid::Direction& direction) const
+{
+    int cellX;
+    int cellY;
+    if (!worldToCell(x, z, cellX, cellY)) {
+        return false;
+    }
+    return exitField.nextStep(walls, cellX, cellY, direction);
+}
+
+// find the shortest path from the start cell to the exit cell, returns false when walls had to be broken
+bool MazeGrid::generatePath() {
+    // Get start and end cell indices
+    int startX = 0;
+    int startY = 0;
+    int endX = width - 1;
+    int endY = height - 1;
+
+    if (findPath(startX, startY, endX, endY, pathCells)) {
+        return true;
+    }
+
+    cout << "No path found from start to end" << endl;
+
+    // Create a direct path by breaking walls, which always connects start and end
+    createDirectPath(startX, startY, endX, endY);
+    findPath(startX, startY, endX, endY, pathCells);
+    return false;
+}
+
+// Helper function to create a direct path by breaking walls
+void MazeGrid::createDirectPath(int startX, int startY, int endX, int endY) {
+    int x = startX;
+    int y = startY;
+    
+    // Move horizontally first
+    while (x < endX) {
+        // Remove the east wall of the current cell (shared with the next cell)
+        setWall(x, y, WallGrid::EAST, false);
+        x++;
+    }
+    
+    // Then move vertically
+    while (y < endY) {
+        // Remove the south wall of the current cell (shared with the cell below)
+        setWall(x, y, WallGrid::SOUTH, false);
+        y++;
+    }
+}
@@ -0,0 +1,205 @@
+#ifndef MAZEGRID_H
+#define MAZEGRID_H
+
+#pragma once
+
+#include <cstdint>
+#include <future>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ChunkGraph.h"
+#include "DistanceField.h"
+#include "FlowFieldCache.h"
+#include "MazeGenerator.h"
+#include "MazeTree.h"
+#include "PathBatch.h"
+#include "PathSolver.h"
+#include "Rng.h"
+#include "WallGrid.h"
+
+using namespace std;
+
+// CPU-side maze model: the wall grid with maze generation, path finding and collision.
+// It holds no GL resources, so it can be used without a context (benchmarks, worker
+// threads) and is built as its own static library; the maze class builds its
+// renderable geometry from it. Separate instances can be used from separate threads.
+// World coordinates are x and z on the floor plane, cell (0, 0) starts at the origin.
+// Generation is deterministic: the same seed, size and generator give a bit-identical
+// wall grid on every platform, identified by getMazeId().
+class MazeGrid
+{
+public:
+    // empty grid, e.g. to load a maze file into
+    MazeGrid();
+
+    // grid with a random seed
+    MazeGrid(int width, int height, float cellSize = 1.0f, float originX = 0.0f, float originZ = 0.0f);
+
+    // grid that generates the maze of the given seed
+    MazeGrid(int width, int height, uint64_t seed, Rng::Kind rngKind = Rng::XOSHIRO256,
+             float cellSize = 1.0f, float originX = 0.0f, float originZ = 0.0f);
+
+    // generate a maze on a worker thread; the result is handed to the maze constructor
+    static future<MazeGrid> generateAsync(int width, int height, uint64_t seed, float cellSize = 1.0f,
+                                          MazeGenerator::Algorithm algorithm = MazeGenerator::DFS);
+
+    // a fresh seed for when no particular maze is asked for
+    static uint64_t randomSeed();
+
+    // identifier of the maze a seed, size and generator produce, usable as a cache key
+    static uint64_t mazeId(uint64_t seed, int width, int height, Rng::Kind rngKind,
+                           MazeGenerator::Algorithm algorithm = MazeGenerator::DFS, int tileSize = 0);
+    uint64_t getMazeId() const;
+
+    // select the seed (and generator) used by the next generateMaze
+    void seed(uint64_t value, Rng::Kind rngKind = Rng::XOSHIRO256);
+    uint64_t getSeed() const { return seedValue; }
+
+    // select the algorithm used by the next generateMaze (depth-first search by default)
+    void setAlgorithm(MazeGenerator::Algorithm value);
+    MazeGenerator::Algorithm getAlgorithm() const { return algorithm; }
+
+    // generate in tiles of tileSize cells on threadCount worker threads (see TiledGenerator);
+    // tileSize 0 generates the whole grid in one piece. The maze depends on the tile size,
+    // not on the thread count, and threadCount <= 0 uses every core
+    void setTiling(int tileSize, int threadCount = 0);
+    int getTileSize() const { return tileSize; }
+
+    // replace the maze with the one in a maze file (see MazeFile), returns false when the file
+    // cannot be used; the file is mapped, so walls are read from disk as they are touched
+    bool loadFile(const string& path);
+
+    // write the maze to a maze file, returns false on an I/O error
+    bool saveFile(const string& path) const;
+
+    // move cell (0, 0) to the given world position
+    void setOrigin(float x, float z);
+
+    // generate the maze with the selected algorithm
+    void generateMaze();
+
+    // scratch memory the last generateMaze used besides the wall grid, in bytes
+    size_t getScratchBytes() const { return lastScratchBytes; }
+
+    // find the shortest path from the start cell to the exit cell, returns false when walls had to be broken
+    bool generatePath();
+
+    // check if the position (world x, z) collides with the maze
+    bool checkCollision(float x, float z) const;
+
+    // move a circle at (world x, z) by (moveX, moveZ) with swept collision against the walls,
+    // sliding along them (see CircleCollider); radius is the clearance kept from the wall center
+    // lines. Returns true when the circle touched a wall
+    bool moveCircle(float& x, float& z, float moveX, float moveZ, float radius) const;
+
+    // moveCircle for count circles in place, returns how many touched a wall
+    size_t moveCircles(float* xs, float* zs, const float* moveXs, const float* moveZs, float radius, size_t count) const;
+
+    // push count circles (world xs[i], zs[i] with radii[i], the clearance from the wall center lines)
+    // out of the walls they overlap, for crowds of bodies (see CollisionBatch): the corrected
+    // positions go to outXs, outZs (may be xs, zs) and bit i % 8 of hitBits[i / 8] is set for every
+    // circle that overlapped a wall. Returns how many did
+    size_t resolveCircles(const float* xs, const float* zs, const float* radii, size_t count,
+                          float* outXs, float* outZs, uint8_t* hitBits) const;
+
+    // cell under the position (world x, z), false when it lies outside the maze
+    bool worldToCell(float x, float z, int& cellX, int& cellY) const;
+
+    // add or remove a wall after generation; keeps the exit distance field up to date
+    void setWall(int x, int y, WallGrid::Direction direction, bool present);
+
+    // distances from every cell to the exit cell, for constant time "which way out" queries;
+    // generateMaze and loadFile drop the field, setWall repairs it
+    void buildExitField();
+    const DistanceField& getExitField() const { return exitField; }
+
+    // direction of the first step toward the exit from the position (world x, z);
+    // false when the field is not built, at the exit, or when the exit cannot be reached
+    bool exitDirection(float x, float z, WallGrid::Direction& direction) const;
+
+    // index a perfect maze (see MazeTree) so path queries between any two cells need no search;
+    // false when the maze has loops or cut-off cells. generateMaze, loadFile and setWall drop it
+    bool buildPathIndex();
+    const MazeTree& getPathIndex() const { return pathIndex; }
+
+    // abstract graph over chunks of chunkSize cells (see ChunkGraph) for routing in huge mazes,
+    // also ones with loops; generateMaze, loadFile and setWall drop it
+    void buildChunkGraph(int chunkSize = 64);
+    const ChunkGraph& getChunkGraph() const { return chunkGraph; }
+
+    // path lengths in cells between count pairs of cells (y * width + x), MazeTree::unreachable when
+    // there is no path; reads the path index when built, else searches each pair like findPath
+    void pathLengths(const uint32_t* from, const uint32_t* to, size_t count, uint32_t* lengths);
+
+    // path between two cells (both included): from the path index when built, else over the chunk
+    // graph when built, else by a search of the whole grid
+    bool findPath(int startX, int startY, int endX, int endY, vector<pair<int, int>>& path);
+
+    // paths for a batch of requests, one search per distinct goal (see PathBatch); the result
+    // stays valid until the next batch
+    const PathBatch& solvePaths(const PathRequest* requests, size_t count);
+
+    // flow field toward a target cell (see FlowFieldCache): one direction byte per cell, cached per
+    // target and evicted least recently used first; null for a cell outside the maze. The pointer
+    // stays valid until the next call; generateMaze, loadFile and setWall drop the cache
+    const uint8_t* getFlowField(int targetX, int targetY);
+    const FlowFieldCache& getFlowFields() const { return flowFields; }
+
+    // memory bound of the flow field cache, in bytes (one per cell and field)
+    void setFlowFieldBudget(size_t bytes) { flowFields.setBudget(bytes); }
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    float getCellSize() const { return cellSize; }
+    float getOriginX() const { return originX; }
+    float getOriginZ() const { return originZ; }
+
+    const WallGrid& getWalls() const { return walls; }
+
+    // cells of the last path, from start to end
+    const vector<pair<int, int>>& getPathCells() const { return pathCells; }
+
+private:
+    int width;
+    int height;
+    float cellSize;
+    float originX;
+    float originZ;
+
+    // bit-packed grid of the maze walls (each shared wall stored once)
+    WallGrid walls;
+
+    // Path from start to end point, and the search scratch kept between calls
+    vector<pair<int, int>> pathCells;
+    PathSolver solver;
+
+    // walking distance to the exit from every cell (empty until buildExitField)
+    DistanceField exitField;
+
+    // path index of a perfect maze (empty until buildPathIndex)
+    MazeTree pathIndex;
+
+    // chunk graph for hierarchical path finding (empty until buildChunkGraph)
+    ChunkGraph chunkGraph;
+
+    // results and scratch of the last solvePaths
+    PathBatch pathBatch;
+
+    // flow fields toward recent targets
+    FlowFieldCache flowFields;
+
+    // seed of the maze and the generator it drives (reseeded by every generateMaze)
+    uint64_t seedValue;
+    Rng rng;
+
+    MazeGenerator::Algorithm algorithm;
+    int tileSize;       // 0 when not tiled, else a multiple of 32
+    int threadCount;
+    size_t lastScratchBytes;
+
+    void createDirectPath(int startX, int startY, int endX, int endY);
+};
+
+#endif
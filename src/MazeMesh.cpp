@@ -0,0 +1,375 @@
+#include "MazeMesh.h"
+#include "TextureCache.h"
+#include <algorithm>
+#include <iostream>
+
+// Faces of a unit cube as four corners each (position, texture coords).
+// The bottom face is left out since walls always stand on the floor.
+static const float cubeFaces[5][4][5] = {
+    // Front face
+    { { -0.5f, -0.5f,  0.5f,  0.0f, 0.0f }, {  0.5f, -0.5f,  0.5f,  1.0f, 0.0f },
+      {  0.5f,  0.5f,  0.5f,  1.0f, 1.0f }, { -0.5f,  0.5f,  0.5f,  0.0f, 1.0f } },
+    // Back face
+    { { -0.5f, -0.5f, -0.5f,  0.0f, 0.0f }, {  0.5f, -0.5f, -0.5f,  1.0f, 0.0f },
+      {  0.5f,  0.5f, -0.5f,  1.0f, 1.0f }, { -0.5f,  0.5f, -0.5f,  0.0f, 1.0f } },
+    // Left face
+    { { -0.5f, -0.5f, -0.5f,  0.0f, 0.0f }, { -0.5f, -0.5f,  0.5f,  1.0f, 0.0f },
+      { -0.5f,  0.5f,  0.5f,  1.0f, 1.0f }, { -0.5f,  0.5f, -0.5f,  0.0f, 1.0f } },
+    // Right face
+    {  { 0.5f, -0.5f, -0.5f,  0.0f, 0.0f }, {  0.5f, -0.5f,  0.5f,  1.0f, 0.0f },
+      {  0.5f,  0.5f,  0.5f,  1.0f, 1.0f }, {  0.5f,  0.5f, -0.5f,  0.0f, 1.0f } },
+    // Top face
+    { { -0.5f,  0.5f, -0.5f,  0.0f, 0.0f }, {  0.5f,  0.5f, -0.5f,  1.0f, 0.0f },
+      {  0.5f,  0.5f,  0.5f,  1.0f, 1.0f }, { -0.5f,  0.5f,  0.5f,  0.0f, 1.0f } }
+};
+
+// Floor quad on the XZ plane, texture tiled 4x4 like the original floor objects
+static const float floorQuad[4][5] = {
+    { -0.5f, 0.0f, -0.5f,  0.0f, 0.0f }, {  0.5f, 0.0f, -0.5f,  4.0f, 0.0f },
+    {  0.5f, 0.0f,  0.5f,  4.0f, 4.0f }, { -0.5f, 0.0f,  0.5f,  0.0f, 4.0f }
+};
+
+MazeMesh::MazeMesh()
+    : VAO(0), VBO(0), EBO(0), visibleChunkCount(0), vertexCount(0), indexCount(0), uploaded(false)
+{
+}
+
+MazeMesh::~MazeMesh()
+{
+    if (uploaded) {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteBuffers(1, &EBO);
+        for (auto& batch : batches) {
+            TextureCache::release(batch.texturePath);
+        }
+    }
+}
+
+// Indices of one baked wall box (five faces, two triangles each)
+static const uint32_t indicesPerWall = 30;
+
+// bake a wall box with the given texture into a chunk, returns the index of the wall
+uint32_t MazeMesh::addWall(const Wall& wall, const string& texturePath, uint32_t chunk)
+{
+    Batch& batch = getBatch(texturePath, 1.0f);
+    uint32_t batchIndex = static_cast<uint32_t>(&batch - batches.data());
+    wallRanges.push_back({ batchIndex, static_cast<uint32_t>(batch.indices.size()), chunk });
+    batch.wallCount++;
+
+    size_t firstVertex = batch.vertices.size();
+    glm::mat4 model = wall.getModelMatrix();
+    for (const auto& face : cubeFaces) {
+        addFace(batch, model, face, wall.getTexScale());
+    }
+
+    // Grow the chunk's bounding box by the baked corners
+    if (chunk >= chunkBounds.size()) {
+        chunkBounds.resize(chunk + 1, { glm::vec3(1e30f), glm::vec3(-1e30f) });
+    }
+    ChunkBounds& bounds = chunkBounds[chunk];
+    for (size_t i = firstVertex; i < batch.vertices.size(); i++) {
+        glm::vec3 corner(batch.vertices[i].x, batch.vertices[i].y, batch.vertices[i].z);
+        bounds.min = glm::min(bounds.min, corner);
+        bounds.max = glm::max(bounds.max, corner);
+    }
+    return static_cast<uint32_t>(wallRanges.size() - 1);
+}
+
+// bake a floor quad with its texture
+void MazeMesh::addFloor(const Floor& floor)
+{
+    Batch& batch = getBatch(floor.getTexturePath(), -1.0f);
+    addFace(batch, floor.getModelMatrix(), floorQuad, glm::vec2(1.0f, 1.0f));
+}
+
+MazeMesh::Batch& MazeMesh::getBatch(const string& texturePath, float polygonOffset)
+{
+    // Batches are keyed by texture and polygon offset, so walls and floors never share one
+    string key = texturePath + (polygonOffset > 0.0f ? "#wall" : "#floor");
+    auto it = batchByTexture.find(key);
+    if (it != batchByTexture.end()) {
+        return batches[it->second];
+    }
+
+    batchByTexture[key] = batches.size();
+    batches.push_back({ texturePath, 0, polygonOffset, {}, {}, 0, 0, 0 });
+    return batches.back();
+}
+
+void MazeMesh::addFace(Batch& batch, const glm::mat4& model, const float corners[4][5], const glm::vec2& texScale)
+{
+    uint32_t base = static_cast<uint32_t>(batch.vertices.size());
+    for (int i = 0; i < 4; i++) {
+        // Transform into world space once, at bake time
+        glm::vec4 world = model * glm::vec4(corners[i][0], corners[i][1], corners[i][2], 1.0f);
+        batch.vertices.push_back({ world.x, world.y, world.z, corners[i][3] * texScale.x, corners[i][4] * texScale.y });
+    }
+
+    // Two triangles per face
+    const uint32_t quadIndices[6] = { 0, 1, 2, 2, 3, 0 };
+    for (uint32_t index : quadIndices) {
+        batch.indices.push_back(base + index);
+    }
+}
+
+// upload the baked geometry to the GPU and release the CPU copy
+void MazeMesh::upload()
+{
+    // Concatenate the batches into one vertex and one index buffer
+    vector<Vertex> vertices;
+    vector<uint32_t> indices;
+    vertexCount = 0;
+    indexCount = 0;
+    for (const auto& batch : batches) {
+        vertexCount += batch.vertices.size();
+        indexCount += batch.indices.size();
+    }
+    vertices.reserve(vertexCount);
+    indices.reserve(indexCount);
+
+    // Walls of each batch, counting-sorted by chunk so every chunk is one contiguous index range
+    size_t chunkCount = chunkBounds.size();
+    vector<vector<uint32_t>> batchWalls(batches.size());
+    for (uint32_t wall = 0; wall < wallRanges.size(); wall++) {
+        batchWalls[wallRanges[wall].batch].push_back(wall);
+    }
+
+    for (size_t b = 0; b < batches.size(); b++) {
+        Batch& batch = batches[b];
+        uint32_t baseVertex = static_cast<uint32_t>(vertices.size());
+        batch.firstIndex = indices.size();
+        batch.indexCount = batch.indices.size();
+
+        vertices.insert(vertices.end(), batch.vertices.begin(), batch.vertices.end());
+
+        if (batch.wallCount == 0) {
+            for (uint32_t index : batch.indices) {
+                indices.push_back(baseVertex + index);
+            }
+        }
+        else {
+            batch.chunkStart.assign(chunkCount + 1, 0);
+            for (uint32_t wall : batchWalls[b]) {
+                batch.chunkStart[wallRanges[wall].chunk + 1] += indicesPerWall;
+            }
+            for (size_t c = 0; c < chunkCount; c++) {
+                batch.chunkStart[c + 1] += batch.chunkStart[c];
+            }
+            for (auto& start : batch.chunkStart) {
+                start += static_cast<uint32_t>(batch.firstIndex);
+            }
+
+            // Copy each wall's indices to the end of its chunk's range so far
+            vector<uint32_t> next(batch.chunkStart.begin(), batch.chunkStart.end() - 1);
+            indices.resize(batch.firstIndex + batch.indexCount);
+            for (uint32_t wall : batchWalls[b]) {
+                WallRange& range = wallRanges[wall];
+                uint32_t target = next[range.chunk];
+                for (uint32_t i = 0; i < indicesPerWall; i++) {
+                    indices[target + i] = baseVertex + batch.indices[range.firstIndex + i];
+                }
+                range.firstIndex = target;
+                next[range.chunk] += indicesPerWall;
+            }
+        }
+
+        batch.textureID = TextureCache::acquire(batch.texturePath);
+
+        // The GPU keeps the only copy from here on
+        vector<Vertex>().swap(batch.vertices);
+        vector<uint32_t>().swap(batch.indices);
+    }
+
+    chunkVisible.assign(chunkCount, 1);
+    visibleChunkCount = chunkCount;
+    drawCounts.resize(batches.size());
+    drawOffsets.resize(batches.size());
+
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
+
+    glBindVertexArray(VAO);
+
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(), GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint32_t), indices.data(), GL_STATIC_DRAW);
+
+    // Position attribute
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    // Texture coordinate attribute
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+
+    glBindVertexArray(0);
+    uploaded = true;
+}
+
+// render every batch, returns the number of draw calls issued
+int MazeMesh::render(shaders* shader, const glm::mat4& view, const glm::mat4& projection,
+                     const vector<uint32_t>* visibleWalls)
+{
+    if (!shader) {
+        cerr << "Shader not initialized!" << endl;
+        return 0;
+    }
+    if (!uploaded || indexCount == 0) {
+        return 0;
+    }
+
+    shader->use();
+
+    // Geometry is already in world space, so the model matrix is the identity
+    glm::mat4 model = glm::mat4(1.0f);
+    glUniformMatrix4fv(glGetUniformLocation(shader->ID, "model"), 1, GL_FALSE, glm::value_ptr(model));
+    glUniformMatrix4fv(glGetUniformLocation(shader->ID, "view"), 1, GL_FALSE, glm::value_ptr(view));
+    glUniformMatrix4fv(glGetUniformLocation(shader->ID, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+    glUniform1i(glGetUniformLocation(shader->ID, "texture1"), 0);
+
+    // Ensure depth test is enabled with proper parameters
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LESS);
+
+    // Disable backface culling to make walls visible from all angles
+    glDisable(GL_CULL_FACE);
+
+    // Prevent z-fighting by using polygon offset
+    glEnable(GL_POLYGON_OFFSET_FILL);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindVertexArray(VAO);
+
+    // Frustum test per chunk
+    frustum.update(projection * view);
+    visibleChunkCount = 0;
+    for (size_t c = 0; c < chunkBounds.size(); c++) {
+        chunkVisible[c] = frustum.intersectsBox(chunkBounds[c].min, chunkBounds[c].max);
+        visibleChunkCount += chunkVisible[c];
+    }
+
+    for (size_t b = 0; b < batches.size(); b++) {
+        drawCounts[b].clear();
+        drawOffsets[b].clear();
+    }
+
+    // Turn the visible walls into index ranges per batch, merging walls that are adjacent in the buffer
+    if (visibleWalls) {
+        sortedWalls.clear();
+        for (uint32_t wall : *visibleWalls) {
+            if (chunkVisible[wallRanges[wall].chunk]) {
+                sortedWalls.push_back(wall);
+            }
+        }
+        sort(sortedWalls.begin(), sortedWalls.end(), [this](uint32_t a, uint32_t b) {
+            return wallRanges[a].firstIndex < wallRanges[b].firstIndex;
+        });
+
+        size_t runEnd = 0;
+        uint32_t runBatch = 0;
+        for (uint32_t wall : sortedWalls) {
+            const WallRange& range = wallRanges[wall];
+            if (!drawCounts[range.batch].empty() && range.batch == runBatch && range.firstIndex == runEnd) {
+                drawCounts[range.batch].back() += indicesPerWall;
+            }
+            else {
+                drawCounts[range.batch].push_back(indicesPerWall);
+                drawOffsets[range.batch].push_back((const void*)(range.firstIndex * sizeof(uint32_t)));
+            }
+            runBatch = range.batch;
+            runEnd = range.firstIndex + indicesPerWall;
+        }
+    }
+    else {
+        // Whole chunks, merging neighbouring visible chunks into one range
+        for (size_t b = 0; b < batches.size(); b++) {
+            const Batch& batch = batches[b];
+            if (batch.wallCount == 0) {
+                continue;
+            }
+            uint32_t runEnd = 0;
+            for (size_t c = 0; c < chunkBounds.size(); c++) {
+                uint32_t first = batch.chunkStart[c];
+                uint32_t count = batch.chunkStart[c + 1] - first;
+                if (!chunkVisible[c] || count == 0) {
+                    continue;
+                }
+                if (!drawCounts[b].empty() && first == runEnd) {
+                    drawCounts[b].back() += count;
+                }
+                else {
+                    drawCounts[b].push_back(count);
+                    drawOffsets[b].push_back((const void*)(first * sizeof(uint32_t)));
+                }
+                runEnd = first + count;
+            }
+        }
+    }
+
+    int drawCalls = 0;
+    for (size_t b = 0; b < batches.size(); b++) {
+        const Batch& batch = batches[b];
+        if (batch.indexCount == 0) {
+            continue;
+        }
+        glPolygonOffset(batch.polygonOffset, batch.polygonOffset);
+        glBindTexture(GL_TEXTURE_2D, batch.textureID);
+
+        if (batch.wallCount > 0) {
+            // Only the visible walls of this batch, in one multi-draw
+            if (drawCounts[b].empty()) {
+                continue;
+            }
+            glMultiDrawElements(GL_TRIANGLES, drawCounts[b].data(), GL_UNSIGNED_INT,
+                                drawOffsets[b].data(), static_cast<GLsizei>(drawCounts[b].size()));
+        }
+        else {
+            glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(batch.indexCount), GL_UNSIGNED_INT,
+                           (void*)(batch.firstIndex * sizeof(uint32_t)));
+        }
+        drawCalls++;
+    }
+
+    glBindVertexArray(0);
+
+    // Disable polygon offset after drawing
+    glDisable(GL_POLYGON_OFFSET_FILL);
+
+    return drawCalls;
+}
+
+size_t MazeMesh::getWallCount() const
+{
+    return wallRanges.size();
+}
+
+size_t MazeMesh::getChunkCount() const
+{
+    return chunkBounds.size();
+}
+
+// chunks that passed the frustum test in the last render
+size_t MazeMesh::getVisibleChunkCount() const
+{
+    return visibleChunkCount;
+}
+
+size_t MazeMesh::getVertexCount() const
+{
+    return vertexCount;
+}
+
+size_t MazeMesh::getIndexCount() const
+{
+    return indexCount;
+}
+
+// size of the vertex and index buffers in bytes
+size_t MazeMesh::getBufferBytes() const
+{
+    return vertexCount * sizeof(Vertex) + indexCount * sizeof(uint32_t);
+}
@@ -0,0 +1,118 @@
+#ifndef MAZEMESH_H
+#define MAZEMESH_H
+
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "shaders.h"
+#include "Wall.h"
+#include "Floor.h"
+#include "Frustum.h"
+using namespace std;
+
+// Static world-space mesh of maze geometry.
+// Walls and floors are baked into one interleaved vertex buffer and one index
+// buffer when the maze is built; geometry sharing a texture forms a batch, so
+// rendering binds the buffers once and issues one draw per texture. Each wall
+// keeps its own index range, so a visible subset of the walls can be drawn.
+// Walls are also grouped into chunks: at upload the walls of a batch are laid
+// out chunk by chunk, and chunks whose bounding box is outside the view
+// frustum are skipped when drawing.
+class MazeMesh
+{
+public:
+    MazeMesh();
+    ~MazeMesh();
+
+    // bake a wall box with the given texture into a chunk, returns the index of the wall
+    uint32_t addWall(const Wall& wall, const string& texturePath, uint32_t chunk = 0);
+
+    // bake a floor quad with its texture
+    void addFloor(const Floor& floor);
+
+    // upload the baked geometry to the GPU and release the CPU copy
+    void upload();
+
+    // render every batch, returns the number of draw calls issued
+    // walls in chunks outside the view frustum are skipped; when visibleWalls is given
+    // only those walls are drawn (floors are always drawn)
+    int render(shaders* shader, const glm::mat4& view, const glm::mat4& projection,
+               const vector<uint32_t>* visibleWalls = nullptr);
+
+    size_t getWallCount() const;
+
+    size_t getChunkCount() const;
+
+    // chunks that passed the frustum test in the last render
+    size_t getVisibleChunkCount() const;
+
+    size_t getVertexCount() const;
+    size_t getIndexCount() const;
+
+    // size of the vertex and index buffers in bytes
+    size_t getBufferBytes() const;
+
+private:
+    struct Vertex {
+        float x, y, z;
+        float u, v;
+    };
+
+    // geometry drawn with one texture
+    struct Batch {
+        string texturePath;
+        unsigned int textureID;
+        float polygonOffset;    // walls are pushed back, floors pulled forward to avoid z-fighting
+        vector<Vertex> vertices;
+        vector<uint32_t> indices;
+        size_t firstIndex;      // offset into the index buffer after upload
+        size_t indexCount;
+        size_t wallCount;       // walls baked into this batch
+        vector<uint32_t> chunkStart;    // absolute index offset of each chunk's walls, chunkCount + 1 entries
+    };
+
+    // index range of one wall box, relative to its batch until upload
+    struct WallRange {
+        uint32_t batch;
+        uint32_t firstIndex;
+        uint32_t chunk;
+    };
+
+    // world-space bounds of the walls in one chunk
+    struct ChunkBounds {
+        glm::vec3 min;
+        glm::vec3 max;
+    };
+
+    unsigned int VAO, VBO, EBO;
+    vector<Batch> batches;
+    unordered_map<string, size_t> batchByTexture;
+    vector<WallRange> wallRanges;
+    vector<ChunkBounds> chunkBounds;
+
+    // chunk visibility of the current frame
+    Frustum frustum;
+    vector<char> chunkVisible;
+    size_t visibleChunkCount;
+
+    // scratch buffers for drawing a subset of the walls
+    vector<uint32_t> sortedWalls;
+    vector<vector<GLsizei>> drawCounts;
+    vector<vector<const void*>> drawOffsets;
+    size_t vertexCount;
+    size_t indexCount;
+    bool uploaded;
+
+    Batch& getBatch(const string& texturePath, float polygonOffset);
+    void addFace(Batch& batch, const glm::mat4& model, const float corners[4][5], const glm::vec2& texScale);
+};
+
+#endif
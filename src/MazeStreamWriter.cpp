@@ -0,0 +1,103 @@
+#include "MazeStreamWriter.h"
+#include "MazeFile.h"
+#include "MazeGenerator.h"
+#include "MazeGrid.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+MazeStreamWriter::MazeStreamWriter()
+    : rowsWritten(0), bytesWritten(0), scratchBytes(0), seconds(0.0), hash(0)
+{
+}
+
+// generate a width x height maze into the file at path, returns false on an I/O error
+bool MazeStreamWriter::write(const string& path, int width, int height, uint64_t seed, Rng::Kind rngKind)
+{
+    rowsWritten = 0;
+    bytesWritten = 0;
+    scratchBytes = 0;
+    seconds = 0.0;
+    if (width <= 0 || height <= 0) {
+        cerr << "MazeStreamWriter: invalid maze size " << width << "x" << height << endl;
+        return false;
+    }
+
+    ofstream file(path, ios::binary | ios::trunc);
+    if (!file) {
+        cerr << "MazeStreamWriter: cannot open " << path << endl;
+        return false;
+    }
+
+    auto start = chrono::steady_clock::now();
+
+    // Same word layout as WallGrid: rows of east/south bits, north boundary, west boundary
+    const size_t rowWords = (static_cast<size_t>(width) + 31) / 32;
+    const size_t northWords = (static_cast<size_t>(width) + 63) / 64;
+    const size_t westWords = (static_cast<size_t>(height) + 63) / 64;
+    const size_t dataWords = WallGrid::wordCount(width, height);
+
+    MazeFileHeader header = MazeFile::makeHeader(width, height, seed, rngKind, MazeGenerator::ELLER, 0,
+                                                 MazeGrid::mazeId(seed, width, height, rngKind, MazeGenerator::ELLER));
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    // The hash follows WallGrid::hash word by word, so it can be compared with an in-memory maze
+    hash = Rng::mix(static_cast<uint64_t>(width) << 32 | static_cast<uint32_t>(height));
+
+    Rng rng(seed, rngKind);
+    EllerRows rows(width);
+    vector<uint64_t> buffer(max(rowWords, max(northWords, westWords)));
+
+    for (int y = 0; y < height; y++) {
+        bool lastRow = y == height - 1;
+        fill(buffer.begin(), buffer.begin() + rowWords, ~uint64_t(0));
+        rows.carveRow(buffer.data(), lastRow, rng);
+        if (lastRow) {
+            // Clear exit (south wall of the last cell)
+            size_t x = static_cast<size_t>(width) - 1;
+            buffer[x >> 5] &= ~(uint64_t(1) << ((x & 31) * 2 + 1));
+        }
+
+        for (size_t i = 0; i < rowWords; i++) {
+            hash = Rng::mix(hash ^ buffer[i]);
+        }
+        if (!MazeFile::writeWords(file, buffer.data(), rowWords)) {
+            cerr << "MazeStreamWriter: write failed at row " << y << " of " << path << endl;
+            return false;
+        }
+        rowsWritten++;
+    }
+
+    // Boundary: closed everywhere except the entrance (north wall of the first cell)
+    fill(buffer.begin(), buffer.begin() + northWords, ~uint64_t(0));
+    buffer[0] &= ~uint64_t(1);
+    for (size_t i = 0; i < northWords; i++) {
+        hash = Rng::mix(hash ^ buffer[i]);
+    }
+    bool written = MazeFile::writeWords(file, buffer.data(), northWords);
+
+    fill(buffer.begin(), buffer.begin() + westWords, ~uint64_t(0));
+    for (size_t i = 0; i < westWords; i++) {
+        hash = Rng::mix(hash ^ buffer[i]);
+    }
+    written = written && MazeFile::writeWords(file, buffer.data(), westWords);
+
+    file.close();
+    if (!written || !file) {
+        cerr << "MazeStreamWriter: write failed for " << path << endl;
+        return false;
+    }
+
+    // WallGrid pads its storage to whole cache lines with set words, and hashes those too
+    for (size_t i = dataWords; i % 8 != 0; i++) {
+        hash = Rng::mix(hash ^ ~uint64_t(0));
+    }
+
+    seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    bytesWritten = sizeof(MazeFileHeader) + dataWords * sizeof(uint64_t);
+    scratchBytes = rows.getScratchBytes() + buffer.size() * sizeof(uint64_t);
+    return true;
+}
@@ -0,0 +1,44 @@
+#ifndef MAZESTREAMWRITER_H
+#define MAZESTREAMWRITER_H
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "Rng.h"
+
+using namespace std;
+
+// Generates an Eller's-algorithm maze straight into a maze file (see MazeFile.h), one row at
+// a time, so memory stays O(width) whatever the height: mazes far larger than RAM only cost
+// disk space. The file holds the same walls MazeGrid generates with the ELLER algorithm
+// for the same seed and size, entrance and exit included.
+class MazeStreamWriter
+{
+public:
+    MazeStreamWriter();
+
+    // generate a width x height maze into the file at path, returns false on an I/O error
+    bool write(const string& path, int width, int height, uint64_t seed, Rng::Kind rngKind = Rng::XOSHIRO256);
+
+    // statistics of the last write
+    size_t getRowsWritten() const { return rowsWritten; }
+    size_t getBytesWritten() const { return bytesWritten; }
+    size_t getScratchBytes() const { return scratchBytes; }
+    double getSeconds() const { return seconds; }
+    double getRowsPerSecond() const { return seconds > 0.0 ? rowsWritten / seconds : 0.0; }
+
+    // hash of the written walls, equal to WallGrid::hash of the same maze in memory
+    uint64_t getHash() const { return hash; }
+
+private:
+    size_t rowsWritten;
+    size_t bytesWritten;
+    size_t scratchBytes;
+    double seconds;
+    uint64_t hash;
+};
+
+#endif
@@ -0,0 +1,261 @@
+#include "MazeTree.h"
+
+#include <algorithm>
+
+namespace {
+
+// Neighbour offsets and the direction leading back, in WallGrid order (N, S, W, E)
+const int dx[4] = { 0, 0, -1, 1 };
+const int dy[4] = { -1, 1, 0, 0 };
+const uint32_t back[4] = { WallGrid::SOUTH, WallGrid::NORTH, WallGrid::EAST, WallGrid::WEST };
+
+// tour entries per block; the in-block min stacks are 32-bit masks
+const uint32_t blockShift = 5;
+const uint32_t blockSize = 1u << blockShift;
+
+}
+
+MazeTree::MazeTree()
+    : width(0), height(0), blockCount(0)
+{
+}
+
+// index the maze, false when the walls do not form a spanning tree
+bool MazeTree::build(const WallGrid& walls)
+{
+    clear();
+    int gridWidth = walls.getWidth();
+    int gridHeight = walls.getHeight();
+    size_t cellCount = static_cast<size_t>(gridWidth) * gridHeight;
+
+    // The tour has 2 * cells - 1 entries and is indexed with 32 bits
+    if (gridWidth <= 0 || gridHeight <= 0 || cellCount > 0x7fffffff) {
+        return false;
+    }
+
+    // Unset depths mark unvisited cells
+    depths.assign(cellCount, unreachable);
+    parentBits.assign((cellCount + 31) / 32, 0);
+    firstVisit.resize(cellCount);
+    tour.reserve(2 * cellCount - 1);
+
+    // Depth-first walk from (0, 0); each stack entry is a cell and the next direction to try
+    vector<uint64_t> stack;
+    stack.push_back(0);
+    depths[0] = 0;
+    firstVisit[0] = 0;
+    tour.push_back(0);
+    size_t visitedCount = 1;
+
+    while (!stack.empty()) {
+        uint64_t& top = stack.back();
+        uint32_t cell = static_cast<uint32_t>(top >> 3);
+        uint32_t dir = static_cast<uint32_t>(top & 7);
+        if (dir == 4) {
+            // Back to the parent, which appears in the tour again
+            stack.pop_back();
+            if (!stack.empty()) {
+                tour.push_back(static_cast<uint32_t>(stack.back() >> 3));
+            }
+            continue;
+        }
+        top++;
+
+        int x = static_cast<int>(cell % gridWidth);
+        int y = static_cast<int>(cell / gridWidth);
+        int nx = x + dx[dir];
+        int ny = y + dy[dir];
+        if (nx < 0 || nx >= gridWidth || ny < 0 || ny >= gridHeight ||
+            walls.hasWall(x, y, static_cast<WallGrid::Direction>(dir))) {
+            continue;
+        }
+        if (cell != 0 && dir == parentDirection(cell)) {
+            continue;
+        }
+
+        // An open wall into a visited cell closes a loop
+        uint32_t next = static_cast<uint32_t>(ny) * gridWidth + nx;
+        if (depths[next] != unreachable) {
+            clear();
+            return false;
+        }
+        depths[next] = depths[cell] + 1;
+        parentBits[next >> 5] |= uint64_t(back[dir]) << ((next & 31) * 2);
+        firstVisit[next] = static_cast<uint32_t>(tour.size());
+        tour.push_back(next);
+        stack.push_back(uint64_t(next) << 3);
+        visitedCount++;
+    }
+
+    // Cells the walk did not reach are cut off from (0, 0)
+    if (visitedCount != cellCount) {
+        clear();
+        return false;
+    }
+
+    // Min stack per block: entry i keeps the positions (bits) of the block entries up to i that
+    // are shallower than everything after them, so the shallowest entry in [first, i] is the
+    // lowest set bit at or above first
+    blockCount = (tour.size() + blockSize - 1) / blockSize;
+    blockMasks.resize(tour.size());
+    for (size_t block = 0; block < blockCount; block++) {
+        size_t blockStart = block * blockSize;
+        size_t blockEnd = min(blockStart + blockSize, tour.size());
+        uint32_t mask = 0;
+        for (size_t i = blockStart; i < blockEnd; i++) {
+            uint32_t depth = depths[tour[i]];
+            while (mask != 0) {
+                uint32_t topBit = 31 - __builtin_clz(mask);
+                if (depths[tour[blockStart + topBit]] < depth) {
+                    break;
+                }
+                mask &= ~(1u << topBit);
+            }
+            mask |= 1u << (i - blockStart);
+            blockMasks[i] = mask;
+        }
+    }
+
+    // Sparse table over the blocks: level k holds the shallowest entry of 2^k blocks from each block
+    size_t levels = 1;
+    while ((size_t(1) << levels) <= blockCount) {
+        levels++;
+    }
+    sparse.resize(levels * blockCount);
+    for (size_t block = 0; block < blockCount; block++) {
+        uint32_t blockStart = static_cast<uint32_t>(block * blockSize);
+        uint32_t blockLast = static_cast<uint32_t>(min(block * blockSize + blockSize, tour.size()) - 1);
+        sparse[block] = minInBlock(blockStart, blockLast);
+    }
+    for (size_t level = 1; level < levels; level++) {
+        size_t half = size_t(1) << (level - 1);
+        const uint32_t* previous = &sparse[(level - 1) * blockCount];
+        uint32_t* current = &sparse[level * blockCount];
+        for (size_t block = 0; block + 2 * half <= blockCount; block++) {
+            current[block] = shallower(previous[block], previous[block + half]);
+        }
+    }
+
+    width = gridWidth;
+    height = gridHeight;
+    return true;
+}
+
+// drop the index
+void MazeTree::clear()
+{
+    width = 0;
+    height = 0;
+    blockCount = 0;
+    depths.clear();
+    parentBits.clear();
+    firstVisit.clear();
+    tour.clear();
+    blockMasks.clear();
+    sparse.clear();
+}
+
+uint32_t MazeTree::parentOf(uint32_t cell) const
+{
+    switch (parentDirection(cell)) {
+    case WallGrid::NORTH:
+        return cell - width;
+    case WallGrid::SOUTH:
+        return cell + width;
+    case WallGrid::WEST:
+        return cell - 1;
+    default:
+        return cell + 1;
+    }
+}
+
+uint32_t MazeTree::minInBlock(uint32_t first, uint32_t last) const
+{
+    uint32_t blockStart = first & ~(blockSize - 1);
+    uint32_t mask = blockMasks[last] & (~0u << (first - blockStart));
+    return blockStart + __builtin_ctz(mask);
+}
+
+uint32_t MazeTree::shallower(uint32_t positionA, uint32_t positionB) const
+{
+    return depths[tour[positionA]] <= depths[tour[positionB]] ? positionA : positionB;
+}
+
+// lowest common ancestor of two cells: the shallowest tour entry between their first visits
+uint32_t MazeTree::commonAncestor(uint32_t a, uint32_t b) const
+{
+    uint32_t first = firstVisit[a];
+    uint32_t last = firstVisit[b];
+    if (first > last) {
+        swap(first, last);
+    }
+
+    uint32_t firstBlock = first >> blockShift;
+    uint32_t lastBlock = last >> blockShift;
+    if (firstBlock == lastBlock) {
+        return tour[minInBlock(first, last)];
+    }
+
+    // Partial blocks at both ends, whole blocks in between from two overlapping table entries
+    uint32_t best = shallower(minInBlock(first, (firstBlock << blockShift) + blockSize - 1),
+                              minInBlock(lastBlock << blockShift, last));
+    if (lastBlock - firstBlock > 1) {
+        uint32_t blocks = lastBlock - firstBlock - 1;
+        uint32_t level = 31 - __builtin_clz(blocks);
+        const uint32_t* row = &sparse[level * blockCount];
+        best = shallower(best, shallower(row[firstBlock + 1], row[lastBlock - (1u << level)]));
+    }
+    return tour[best];
+}
+
+// cells to walk from a to b
+uint32_t MazeTree::pathLength(uint32_t a, uint32_t b) const
+{
+    size_t cellCount = depths.size();
+    if (!isBuilt() || a >= cellCount || b >= cellCount) {
+        return unreachable;
+    }
+    return depths[a] + depths[b] - 2 * depths[commonAncestor(a, b)];
+}
+
+// pathLength of count pairs
+void MazeTree::pathLengths(const uint32_t* from, const uint32_t* to, size_t count, uint32_t* lengths) const
+{
+    for (size_t i = 0; i < count; i++) {
+        lengths[i] = pathLength(from[i], to[i]);
+    }
+}
+
+// the path from a to b: up from a to the common ancestor, then down to b
+bool MazeTree::findPath(uint32_t a, uint32_t b, vector<pair<int, int>>& path) const
+{
+    path.clear();
+    uint32_t length = pathLength(a, b);
+    if (length == unreachable) {
+        return false;
+    }
+    uint32_t ancestor = commonAncestor(a, b);
+    path.reserve(length + 1);
+
+    for (uint32_t cell = a; ; cell = parentOf(cell)) {
+        path.push_back({ static_cast<int>(cell % width), static_cast<int>(cell / width) });
+        if (cell == ancestor)
+            break;
+    }
+
+    // b's side is collected upward and turned around
+    size_t turn = path.size();
+    for (uint32_t cell = b; cell != ancestor; cell = parentOf(cell)) {
+        path.push_back({ static_cast<int>(cell % width), static_cast<int>(cell / width) });
+    }
+    reverse(path.begin() + turn, path.end());
+    return true;
+}
+
+// bytes used by the index
+size_t MazeTree::memoryBytes() const
+{
+    return depths.capacity() * sizeof(uint32_t) + parentBits.capacity() * sizeof(uint64_t) +
+           firstVisit.capacity() * sizeof(uint32_t) + tour.capacity() * sizeof(uint32_t) +
+           blockMasks.capacity() * sizeof(uint32_t) + sparse.capacity() * sizeof(uint32_t);
+}
@@ -0,0 +1,77 @@
+#ifndef MAZETREE_H
+#define MAZETREE_H
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "WallGrid.h"
+
+using namespace std;
+
+// Path index of a perfect maze (every cell reachable, no loops), where the open walls form a
+// spanning tree and the path between two cells is unique.
+// One depth-first walk from cell (0, 0) records each cell's depth and parent direction and the
+// Euler tour of the tree; the lowest common ancestor of two cells is the shallowest cell between
+// their first visits in the tour. That range minimum is answered in constant time from a sparse
+// table over blocks of 32 tour entries plus a 32-bit min-stack mask per entry for the partial
+// blocks, so the index takes about 28 bytes per cell.
+// A path length is then depth(a) + depth(b) - 2 depth(lca), and the path itself is read off
+// the parent directions in O(length) without any search.
+// Cells are numbered y * width + x, as elsewhere.
+class MazeTree
+{
+public:
+    // length of pairs that have no path (index not built, or a cell outside the grid)
+    static constexpr uint32_t unreachable = 0xffffffffu;
+
+    MazeTree();
+
+    // index the maze; returns false (and stays empty) when the walls do not form a spanning tree
+    bool build(const WallGrid& walls);
+
+    // drop the index (e.g. after a new maze was generated or a wall changed)
+    void clear();
+    bool isBuilt() const { return width > 0; }
+
+    // lowest common ancestor of two cells, with (0, 0) as the root
+    uint32_t commonAncestor(uint32_t a, uint32_t b) const;
+
+    // cells to walk from a to b, or unreachable
+    uint32_t pathLength(uint32_t a, uint32_t b) const;
+
+    // pathLength of count pairs (from[i], to[i]) into lengths[i]
+    void pathLengths(const uint32_t* from, const uint32_t* to, size_t count, uint32_t* lengths) const;
+
+    // the path from a to b (both included), like PathSolver::findPath; false when there is none
+    bool findPath(uint32_t a, uint32_t b, vector<pair<int, int>>& path) const;
+
+    // steps from the root (0, 0)
+    uint32_t getDepth(uint32_t cell) const { return depths[cell]; }
+
+    // bytes used by the index
+    size_t memoryBytes() const;
+
+private:
+    int width;
+    int height;
+    vector<uint32_t> depths;        // per cell
+    vector<uint64_t> parentBits;    // direction to the parent cell (WallGrid::Direction), 2 bits per cell
+    vector<uint32_t> firstVisit;    // per cell, position of its first entry in the tour
+    vector<uint32_t> tour;          // Euler tour, 2 * cells - 1 cells
+    vector<uint32_t> blockMasks;    // per tour entry, positions of the block's min stack up to it
+    vector<uint32_t> sparse;        // per level and block, tour position of the shallowest entry
+    size_t blockCount;
+
+    uint32_t parentDirection(uint32_t cell) const { return (parentBits[cell >> 5] >> ((cell & 31) * 2)) & 3u; }
+    uint32_t parentOf(uint32_t cell) const;
+
+    // tour position of the shallowest entry in [first, last]
+    uint32_t minInBlock(uint32_t first, uint32_t last) const;
+    uint32_t shallower(uint32_t positionA, uint32_t positionB) const;
+};
+
+#endif
@@ -0,0 +1,216 @@
+#include "PathBatch.h"
+
+#include <algorithm>
+
+namespace {
+
+// Neighbour offsets and the direction leading back, in WallGrid order (N, S, W, E)
+const int dx[4] = { 0, 0, -1, 1 };
+const int dy[4] = { -1, 1, 0, 0 };
+const uint32_t back[4] = { WallGrid::SOUTH, WallGrid::NORTH, WallGrid::EAST, WallGrid::WEST };
+
+bool testBit(const vector<uint64_t>& bits, size_t index)
+{
+    return (bits[index >> 6] >> (index & 63)) & 1u;
+}
+
+}
+
+PathBatch::PathBatch()
+    : width(0), height(0), stepCount(0), lastWord(0), queue(1024), searchCount(0), visitedCount(0)
+{
+}
+
+// solve count requests through the walls
+void PathBatch::solve(const WallGrid& walls, const PathRequest* requests, size_t count)
+{
+    width = walls.getWidth();
+    height = walls.getHeight();
+    starts.resize(count);
+    lengths.assign(count, unreachable);
+    offsets.assign(count, 0);
+    stepCount = 0;
+    lastWord = 0;
+    searchCount = 0;
+    visitedCount = 0;
+
+    // Scratch grows to the grid once
+    size_t cellCount = static_cast<size_t>(max(width, 0)) * max(height, 0);
+    if (visitedBits.size() < (cellCount + 63) / 64) {
+        visitedBits.resize((cellCount + 63) / 64);
+        startBits.assign((cellCount + 63) / 64, 0);
+        towardBits.resize((cellCount + 31) / 32);
+    }
+
+    // Requests with the same goal next to each other
+    order.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        order[i] = static_cast<uint32_t>(i);
+        starts[i] = requests[i].start;
+    }
+    sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return requests[a].goal != requests[b].goal ? requests[a].goal < requests[b].goal : a < b;
+    });
+
+    size_t first = 0;
+    while (first < count) {
+        size_t last = first + 1;
+        while (last < count && requests[order[last]].goal == requests[order[first]].goal) {
+            last++;
+        }
+        if (requests[order[first]].goal < cellCount) {
+            searchGroup(walls, requests, first, last);
+        }
+        first = last;
+    }
+    if ((stepCount & 31) != 0) {
+        flushSteps();
+    }
+}
+
+// breadth-first search outward from the group's goal, then read each start's path off it
+void PathBatch::searchGroup(const WallGrid& walls, const PathRequest* requests, size_t first, size_t last)
+{
+    size_t cellCount = static_cast<size_t>(width) * height;
+    uint32_t goal = requests[order[first]].goal;
+
+    // The starts still to reach, each cell counted once
+    size_t pending = 0;
+    for (size_t i = first; i < last; i++) {
+        uint32_t start = requests[order[i]].start;
+        if (start < cellCount && !testBit(startBits, start)) {
+            startBits[start >> 6] |= uint64_t(1) << (start & 63);
+            pending++;
+        }
+    }
+
+    fill(visitedBits.begin(), visitedBits.begin() + (cellCount + 63) / 64, 0);
+    auto visit = [&](uint32_t cell, uint32_t direction) {
+        visitedBits[cell >> 6] |= uint64_t(1) << (cell & 63);
+        uint64_t& word = towardBits[cell >> 5];
+        unsigned shift = (cell & 31) * 2;
+        word = (word & ~(uint64_t(3) << shift)) | (uint64_t(direction) << shift);
+        if (testBit(startBits, cell)) {
+            startBits[cell >> 6] &= ~(uint64_t(1) << (cell & 63));
+            pending--;
+        }
+    };
+
+    // Cell index offsets in WallGrid order (N, S, W, E)
+    const ptrdiff_t step[4] = { -static_cast<ptrdiff_t>(width), width, -1, 1 };
+
+    searchCount++;
+    visit(goal, 0);
+    visitedCount++;
+    size_t head = 0;
+    size_t queued = 1;
+    size_t mask = queue.size() - 1;
+    queue[0] = goal;
+    while (queued > 0 && pending > 0) {
+        uint32_t cell = queue[head];
+        head = (head + 1) & mask;
+        queued--;
+
+        int y = static_cast<int>(cell / static_cast<uint32_t>(width));
+        int x = static_cast<int>(cell - static_cast<uint32_t>(y) * static_cast<uint32_t>(width));
+        for (int dir = 0; dir < 4; dir++) {
+            int nx = x + dx[dir];
+            int ny = y + dy[dir];
+            if (nx < 0 || nx >= width || ny < 0 || ny >= height ||
+                walls.hasWall(x, y, static_cast<WallGrid::Direction>(dir))) {
+                continue;
+            }
+            uint32_t neighbour = static_cast<uint32_t>(ny) * width + nx;
+            if (testBit(visitedBits, neighbour)) {
+                continue;
+            }
+            // The neighbour steps back toward the goal
+            visit(neighbour, back[dir]);
+            visitedCount++;
+
+            if (queued == queue.size()) {
+                vector<uint32_t> larger(queue.size() * 2);
+                for (size_t i = 0; i < queued; i++) {
+                    larger[i] = queue[(head + i) & mask];
+                }
+                queue.swap(larger);
+                head = 0;
+                mask = queue.size() - 1;
+            }
+            queue[(head + queued) & mask] = neighbour;
+            queued++;
+        }
+    }
+
+    // Read the paths off the directions toward the goal; starts never reached are unset again
+    for (size_t i = first; i < last; i++) {
+        uint32_t request = order[i];
+        uint32_t start = requests[request].start;
+        if (start >= cellCount) {
+            continue;
+        }
+        if (!testBit(visitedBits, start)) {
+            startBits[start >> 6] &= ~(uint64_t(1) << (start & 63));
+            continue;
+        }
+
+        offsets[request] = stepCount;
+        uint32_t length = 0;
+        for (uint32_t cell = start; cell != goal; length++) {
+            uint32_t direction = (towardBits[cell >> 5] >> ((cell & 31) * 2)) & 3u;
+            appendStep(direction);
+            cell = static_cast<uint32_t>(cell + step[direction]);
+        }
+        lengths[request] = length;
+    }
+}
+
+void PathBatch::appendStep(uint32_t direction)
+{
+    // The last word is kept in a register and stored once it is full
+    lastWord |= uint64_t(direction) << ((stepCount & 31) * 2);
+    if ((++stepCount & 31) == 0) {
+        flushSteps();
+    }
+}
+
+// store the last, partly filled word of steps
+void PathBatch::flushSteps()
+{
+    size_t word = (stepCount - 1) >> 5;
+    if (word >= steps.size())
+        steps.push_back(lastWord);
+    else
+        steps[word] = lastWord;
+    if ((stepCount & 31) == 0) {
+        lastWord = 0;
+    }
+}
+
+// cells of path i from start to goal
+void PathBatch::getCells(size_t i, vector<pair<int, int>>& cells) const
+{
+    cells.clear();
+    if (lengths[i] == unreachable) {
+        return;
+    }
+    int x = static_cast<int>(starts[i] % width);
+    int y = static_cast<int>(starts[i] / width);
+    cells.reserve(lengths[i] + 1);
+    cells.push_back({ x, y });
+    for (uint32_t s = 0; s < lengths[i]; s++) {
+        WallGrid::Direction direction = getStep(i, s);
+        x += dx[direction];
+        y += dy[direction];
+        cells.push_back({ x, y });
+    }
+}
+
+// bytes held by the results and the search scratch
+size_t PathBatch::memoryBytes() const
+{
+    return (starts.capacity() + lengths.capacity()) * sizeof(uint32_t) + offsets.capacity() * sizeof(uint64_t) +
+           steps.capacity() * sizeof(uint64_t) + order.capacity() * sizeof(uint32_t) +
+           (visitedBits.capacity() + startBits.capacity() + towardBits.capacity()) * sizeof(uint64_t) +
+           queue.capacity() * sizeof(uint32_t);
+}
@@ -0,0 +1,93 @@
+#ifndef PATHBATCH_H
+#define PATHBATCH_H
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "WallGrid.h"
+
+using namespace std;
+
+// one path request between two cells, numbered y * width + x
+struct PathRequest {
+    uint32_t start;
+    uint32_t goal;
+};
+
+// Shortest paths for many agents at once.
+// Requests are grouped by goal and each goal gets a single breadth-first search outward from it,
+// which leaves every visited cell pointing one step toward the goal (a flow field) and stops as
+// soon as all starts of the group are reached. Each path is then read off those directions from
+// its start. Paths are stored as 2-bit directions (WallGrid::Direction) in one shared buffer;
+// all buffers are kept between batches, so a batch allocates nothing once they have grown.
+class PathBatch
+{
+public:
+    // length of requests that have no path (a cell outside the grid, or cut off from the goal)
+    static constexpr uint32_t unreachable = 0xffffffffu;
+
+    PathBatch();
+
+    // solve count requests through the walls; the results stay valid until the next solve
+    void solve(const WallGrid& walls, const PathRequest* requests, size_t count);
+
+    size_t getCount() const { return lengths.size(); }
+
+    // steps of path i (its cells minus one), or unreachable
+    uint32_t getLength(size_t i) const { return lengths[i]; }
+
+    // direction of step s of path i, from its start toward its goal
+    WallGrid::Direction getStep(size_t i, uint32_t s) const;
+
+    // cells of path i from start to goal (both included); empty when it has no path
+    void getCells(size_t i, vector<pair<int, int>>& cells) const;
+
+    // steps of all paths together
+    uint64_t getStepCount() const { return stepCount; }
+
+    // searches the last batch ran (distinct goals) and the cells they visited
+    size_t getSearchCount() const { return searchCount; }
+    size_t getVisitedCount() const { return visitedCount; }
+
+    // bytes held by the results and the search scratch
+    size_t memoryBytes() const;
+
+private:
+    int width;
+    int height;
+
+    // results: per request its start, its length and the position of its first step in steps
+    vector<uint32_t> starts;
+    vector<uint32_t> lengths;
+    vector<uint64_t> offsets;
+    vector<uint64_t> steps;         // 2 bits per step, 32 steps per word
+    uint64_t stepCount;
+    uint64_t lastWord;              // the word being filled, stored to steps when full
+
+    // search scratch
+    vector<uint32_t> order;         // request indices sorted by goal
+    vector<uint64_t> visitedBits;   // one bit per cell
+    vector<uint64_t> startBits;     // starts of the current group not reached yet
+    vector<uint64_t> towardBits;    // direction one step toward the goal, 2 bits per cell
+    vector<uint32_t> queue;         // ring buffer of cell indices, size a power of two
+    size_t searchCount;
+    size_t visitedCount;
+
+    // breadth-first search outward from goal until every start in the group is reached
+    void searchGroup(const WallGrid& walls, const PathRequest* requests, size_t first, size_t last);
+
+    void appendStep(uint32_t direction);
+    void flushSteps();
+};
+
+inline WallGrid::Direction PathBatch::getStep(size_t i, uint32_t s) const
+{
+    uint64_t position = offsets[i] + s;
+    return static_cast<WallGrid::Direction>((steps[position >> 5] >> ((position & 31) * 2)) & 3u);
+}
+
+#endif
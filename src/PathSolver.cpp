@@ -0,0 +1,132 @@
+#include "PathSolver.h"
+
+#include <algorithm>
+
+PathSolver::PathSolver()
+    : queue(1024), visitedCount(0)
+{
+}
+
+// shortest path between two cells through open walls, from start to end (both included)
+bool PathSolver::findPath(const WallGrid& walls, int startX, int startY, int endX, int endY, vector<pair<int, int>>& path)
+{
+    path.clear();
+    visitedCount = 0;
+
+    int width = walls.getWidth();
+    int height = walls.getHeight();
+    if (startX < 0 || startX >= width || startY < 0 || startY >= height ||
+        endX < 0 || endX >= width || endY < 0 || endY >= height) {
+        return false;
+    }
+
+    // Scratch grows to the grid once and is only cleared afterwards
+    size_t cellCount = static_cast<size_t>(width) * height;
+    size_t wordCount = (cellCount + 63) / 64;
+    if (visitedBits.size() < wordCount) {
+        visitedBits.resize(wordCount);
+        parentBits.resize((cellCount + 31) / 32);
+    }
+    fill(visitedBits.begin(), visitedBits.begin() + wordCount, 0);
+
+    auto isVisited = [&](size_t cell) { return (visitedBits[cell >> 6] >> (cell & 63)) & 1u; };
+    auto visit = [&](size_t cell, uint32_t parentDirection) {
+        visitedBits[cell >> 6] |= uint64_t(1) << (cell & 63);
+        uint64_t& word = parentBits[cell >> 5];
+        unsigned shift = (cell & 31) * 2;
+        word = (word & ~(uint64_t(3) << shift)) | (uint64_t(parentDirection) << shift);
+    };
+
+    // Neighbour offsets and the direction leading back, in WallGrid order (N, S, W, E)
+    const ptrdiff_t step[4] = { -static_cast<ptrdiff_t>(width), width, -1, 1 };
+    const uint32_t back[4] = { WallGrid::SOUTH, WallGrid::NORTH, WallGrid::EAST, WallGrid::WEST };
+
+    size_t start = static_cast<size_t>(startY) * width + startX;
+    size_t end = static_cast<size_t>(endY) * width + endX;
+    visit(start, 0);
+    visitedCount = 1;
+
+    size_t head = 0;
+    size_t count = 0;
+    size_t mask = queue.size() - 1;
+    queue[0] = static_cast<uint32_t>(start);
+    count = 1;
+
+    bool found = start == end;
+    while (count > 0 && !found) {
+        uint32_t index = queue[head];
+        head = (head + 1) & mask;
+        count--;
+
+        // 32-bit division, much cheaper than on size_t
+        size_t cell = index;
+        int y = static_cast<int>(index / static_cast<uint32_t>(width));
+        int x = static_cast<int>(index - static_cast<uint32_t>(y) * static_cast<uint32_t>(width));
+
+        // Open walls that lead to another cell (the entrance and exit lead out of the grid)
+        uint32_t open = static_cast<uint32_t>(y > 0 && !walls.hasWall(x, y, WallGrid::NORTH))
+                      | static_cast<uint32_t>(y < height - 1 && !walls.hasWall(x, y, WallGrid::SOUTH)) << 1
+                      | static_cast<uint32_t>(x > 0 && !walls.hasWall(x, y, WallGrid::WEST)) << 2
+                      | static_cast<uint32_t>(x < width - 1 && !walls.hasWall(x, y, WallGrid::EAST)) << 3;
+
+        for (int direction = 0; direction < 4; direction++) {
+            if (!(open >> direction & 1u)) {
+                continue;
+            }
+            size_t neighbour = cell + step[direction];
+            if (isVisited(neighbour)) {
+                continue;
+            }
+            visit(neighbour, back[direction]);
+            visitedCount++;
+            if (neighbour == end) {
+                found = true;
+                break;
+            }
+
+            if (count == queue.size()) {
+                growQueue(head, count);
+                head = 0;
+                mask = queue.size() - 1;
+            }
+            queue[(head + count) & mask] = static_cast<uint32_t>(neighbour);
+            count++;
+        }
+    }
+
+    if (!found) {
+        return false;
+    }
+
+    // Follow the parent directions back from the end, then reverse to go from start to end
+    const int dx[4] = { 0, 0, -1, 1 };
+    const int dy[4] = { -1, 1, 0, 0 };
+    int x = endX;
+    int y = endY;
+    path.push_back({ x, y });
+    while (x != startX || y != startY) {
+        size_t cell = static_cast<size_t>(y) * width + x;
+        uint32_t direction = (parentBits[cell >> 5] >> ((cell & 31) * 2)) & 3u;
+        x += dx[direction];
+        y += dy[direction];
+        path.push_back({ x, y });
+    }
+    reverse(path.begin(), path.end());
+    return true;
+}
+
+// double the ring buffer, unrolling its contents to start at index 0
+void PathSolver::growQueue(size_t head, size_t count)
+{
+    vector<uint32_t> larger(queue.size() * 2);
+    for (size_t i = 0; i < count; i++) {
+        larger[i] = queue[(head + i) & (queue.size() - 1)];
+    }
+    queue.swap(larger);
+}
+
+// scratch memory held between searches, in bytes
+size_t PathSolver::getScratchBytes() const
+{
+    return (visitedBits.size() + parentBits.size()) * sizeof(uint64_t) + queue.size() * sizeof(uint32_t);
+}
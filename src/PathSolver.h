@@ -0,0 +1,44 @@
+#ifndef PATHSOLVER_H
+#define PATHSOLVER_H
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "WallGrid.h"
+
+using namespace std;
+
+// Shortest paths through a maze by breadth-first search on flat arrays.
+// Per cell it keeps one visited bit and the direction back to the parent in 2 bits, and the
+// queue is a ring buffer that only grows to the widest search front, so a 100M cell grid
+// needs under 40 MB of scratch. The buffers are kept between searches, nothing is allocated
+// once they have grown to the grid size, and nothing recurses.
+class PathSolver
+{
+public:
+    PathSolver();
+
+    // shortest path between two cells through open walls, from start to end (both included);
+    // returns false and leaves path empty when the end cannot be reached
+    bool findPath(const WallGrid& walls, int startX, int startY, int endX, int endY, vector<pair<int, int>>& path);
+
+    // cells reached by the last search
+    size_t getVisitedCount() const { return visitedCount; }
+
+    // scratch memory held between searches, in bytes
+    size_t getScratchBytes() const;
+
+private:
+    vector<uint64_t> visitedBits;   // one bit per cell
+    vector<uint64_t> parentBits;    // direction to the parent cell (WallGrid::Direction), 2 bits per cell
+    vector<uint32_t> queue;         // ring buffer of cell indices, size a power of two
+    size_t visitedCount;
+
+    void growQueue(size_t head, size_t count);
+};
+
+#endif
@@ -0,0 +1,175 @@
+#include "PortalCuller.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// tolerance for direction tests on normalized vectors
+const float angleEpsilon = 1e-5f;
+
+// keeps the viewer off the grid lines of its own cell, where portal wedges degenerate
+const float viewerInset = 1e-3f;
+
+}
+
+PortalCuller::PortalCuller()
+    : frame(0), steps(0), stepBudget(size_t(1) << 22), budgetExceeded(false)
+{
+}
+
+// walk the portals from the viewer position, returns the visible cells (y * width + x)
+const vector<uint32_t>& PortalCuller::computeVisibleCells(const WallGrid& walls, float viewerX, float viewerZ,
+                                                          float directionX, float directionZ, float halfAngle,
+                                                          float maxDistance)
+{
+    int width = walls.getWidth();
+    int height = walls.getHeight();
+
+    visibleCells.clear();
+    stack.clear();
+    steps = 0;
+    budgetExceeded = false;
+    if (width <= 0 || height <= 0) {
+        return visibleCells;
+    }
+
+    // Stamps make "visible this walk" a compare instead of clearing the whole grid
+    size_t cellCount = static_cast<size_t>(width) * height;
+    if (cellStamp.size() != cellCount) {
+        cellStamp.assign(cellCount, 0);
+        frame = 0;
+    }
+    if (++frame == 0) {
+        fill(cellStamp.begin(), cellStamp.end(), 0);
+        frame = 1;
+    }
+
+    // Viewer cell, with the viewer nudged inside it
+    int cellX = min(max(static_cast<int>(floor(viewerX)), 0), width - 1);
+    int cellY = min(max(static_cast<int>(floor(viewerZ)), 0), height - 1);
+    viewerX = min(max(viewerX, cellX + viewerInset), cellX + 1 - viewerInset);
+    viewerZ = min(max(viewerZ, cellY + viewerInset), cellY + 1 - viewerInset);
+
+    markVisible(cellX, cellY, width);
+
+    // A zero-length direction or a wedge of 180 degrees or more means every portal of the start cell is open
+    float length = sqrt(directionX * directionX + directionZ * directionZ);
+    bool fullView = halfAngle >= 1.5707963f || length < angleEpsilon;
+
+    Vec2 left = { 0.0f, 0.0f };
+    Vec2 right = { 0.0f, 0.0f };
+    if (!fullView) {
+        directionX /= length;
+        directionZ /= length;
+        float c = cos(halfAngle);
+        float s = sin(halfAngle);
+        left = { directionX * c - directionZ * s, directionX * s + directionZ * c };
+        right = { directionX * c + directionZ * s, -directionX * s + directionZ * c };
+    }
+
+    if (fullView) {
+        // Zero vectors mark "no wedge yet": the first portal's own wedge is taken as is
+        pushPortals(walls, cellX, cellY, Vec2{ 0.0f, 0.0f }, Vec2{ 0.0f, 0.0f }, viewerX, viewerZ, maxDistance);
+    }
+    else {
+        pushPortals(walls, cellX, cellY, left, right, viewerX, viewerZ, maxDistance);
+    }
+
+    while (!stack.empty()) {
+        if (++steps > stepBudget) {
+            budgetExceeded = true;
+            break;
+        }
+
+        Entry entry = stack.back();
+        stack.pop_back();
+
+        markVisible(entry.x, entry.y, width);
+        pushPortals(walls, entry.x, entry.y, entry.left, entry.right, viewerX, viewerZ, maxDistance);
+    }
+
+    return visibleCells;
+}
+
+void PortalCuller::markVisible(int x, int y, int width)
+{
+    uint32_t index = static_cast<uint32_t>(y) * width + x;
+    if (cellStamp[index] != frame) {
+        cellStamp[index] = frame;
+        visibleCells.push_back(index);
+    }
+}
+
+void PortalCuller::pushPortals(const WallGrid& walls, int x, int y, const Vec2& left, const Vec2& right,
+                               float viewerX, float viewerZ, float maxDistance)
+{
+    auto cross = [](const Vec2& a, const Vec2& b) { return a.x * b.z - a.z * b.x; };
+    auto normalize = [](float vx, float vz) {
+        float length = sqrt(vx * vx + vz * vz);
+        return Vec2{ vx / length, vz / length };
+    };
+    auto inside = [&](const Vec2& wedgeLeft, const Vec2& wedgeRight, const Vec2& d) {
+        return cross(wedgeRight, d) >= -angleEpsilon && cross(d, wedgeLeft) >= -angleEpsilon;
+    };
+    bool hasWedge = left.x != 0.0f || left.z != 0.0f;
+
+    // Portal endpoints (grid coordinates) and the neighbour behind each direction (N, S, W, E)
+    const int dx[4] = { 0, 0, -1, 1 };
+    const int dy[4] = { -1, 1, 0, 0 };
+    float x0[4] = { float(x), float(x), float(x), float(x + 1) };
+    float z0[4] = { float(y), float(y + 1), float(y), float(y) };
+    float x1[4] = { float(x + 1), float(x + 1), float(x), float(x + 1) };
+    float z1[4] = { float(y), float(y + 1), float(y + 1), float(y + 1) };
+
+    // How far the portal line lies ahead of the viewer when moving through it
+    float ahead[4] = { viewerZ - y, (y + 1) - viewerZ, viewerX - x, (x + 1) - viewerX };
+
+    for (int dir = 0; dir < 4; dir++) {
+        int nx = x + dx[dir];
+        int ny = y + dy[dir];
+        if (nx < 0 || nx >= walls.getWidth() || ny < 0 || ny >= walls.getHeight()) {
+            continue;
+        }
+        if (walls.hasWall(x, y, static_cast<WallGrid::Direction>(dir))) {
+            continue;
+        }
+
+        // Only walk away from the viewer
+        if (ahead[dir] <= 1e-6f) {
+            continue;
+        }
+
+        // Skip portals beyond the far plane (closest point of the segment to the viewer)
+        float closestX = min(max(viewerX, x0[dir]), x1[dir]);
+        float closestZ = min(max(viewerZ, z0[dir]), z1[dir]);
+        float distX = closestX - viewerX;
+        float distZ = closestZ - viewerZ;
+        if (distX * distX + distZ * distZ > maxDistance * maxDistance) {
+            continue;
+        }
+
+        // Wedge spanned by the portal as seen from the viewer
+        Vec2 a = normalize(x0[dir] - viewerX, z0[dir] - viewerZ);
+        Vec2 b = normalize(x1[dir] - viewerX, z1[dir] - viewerZ);
+        Vec2 portalRight = cross(a, b) >= 0.0f ? a : b;
+        Vec2 portalLeft = cross(a, b) >= 0.0f ? b : a;
+
+        Vec2 newLeft = portalLeft;
+        Vec2 newRight = portalRight;
+        if (hasWedge) {
+            // Intersect with the current wedge: the later right edge and the earlier left edge
+            newRight = cross(right, portalRight) >= 0.0f ? portalRight : right;
+            newLeft = cross(portalLeft, left) >= 0.0f ? portalLeft : left;
+
+            // Both edges must lie in both wedges, otherwise the wedges do not overlap
+            if (cross(newRight, newLeft) < -angleEpsilon ||
+                !inside(left, right, newRight) || !inside(left, right, newLeft) ||
+                !inside(portalLeft, portalRight, newRight) || !inside(portalLeft, portalRight, newLeft)) {
+                continue;
+            }
+        }
+
+        stack.push_back({ nx, ny, newLeft, newRight });
+    }
+}
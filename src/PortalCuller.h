@@ -0,0 +1,66 @@
+#ifndef PORTALCULLER_H
+#define PORTALCULLER_H
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "WallGrid.h"
+
+using namespace std;
+
+// Cell-and-portal visibility for a maze seen from above.
+// Starting at the viewer's cell, it walks through open cell edges (portals)
+// and narrows the horizontal view wedge to each opening, so only cells that
+// can be seen through the chain of openings are reported as visible.
+// Coordinates are in cell units relative to the maze origin (x = column, z = row).
+class PortalCuller
+{
+public:
+    PortalCuller();
+
+    // walk the portals from the viewer position, returns the visible cells (y * width + x)
+    // halfAngle is the horizontal half field of view in radians; anything >= pi/2 is treated as
+    // a full view around the viewer
+    const vector<uint32_t>& computeVisibleCells(const WallGrid& walls, float viewerX, float viewerZ,
+                                                float directionX, float directionZ, float halfAngle,
+                                                float maxDistance);
+
+    // true when the last walk hit its step budget; the caller should not cull in that case
+    bool overflowed() const { return budgetExceeded; }
+
+    // portal steps taken by the last walk
+    size_t getStepCount() const { return steps; }
+
+    // limit on portal steps per walk, guards against mazes with many loops
+    void setStepBudget(size_t budget) { stepBudget = budget; }
+
+private:
+    // a 2D direction
+    struct Vec2 {
+        float x, z;
+    };
+
+    // cell to enter together with the view wedge narrowed by the portals so far
+    // (directions d with cross(right, d) >= 0 and cross(d, left) >= 0)
+    struct Entry {
+        int x, y;
+        Vec2 left, right;
+    };
+
+    vector<uint32_t> visibleCells;
+    vector<uint32_t> cellStamp;    // frame stamp per cell, avoids clearing between walks
+    uint32_t frame;
+    vector<Entry> stack;
+    size_t steps;
+    size_t stepBudget;
+    bool budgetExceeded;
+
+    void markVisible(int x, int y, int width);
+    void pushPortals(const WallGrid& walls, int x, int y, const Vec2& left, const Vec2& right,
+                     float viewerX, float viewerZ, float maxDistance);
+};
+
+#endif
@@ -0,0 +1,192 @@
+#include "PotentiallyVisibleSet.h"
+#include "PortalCuller.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+namespace {
+
+// cells handed to a worker at a time
+const uint32_t cellsPerBlock = 256;
+
+}
+
+PotentiallyVisibleSet::PotentiallyVisibleSet()
+    : width(0), height(0), incompleteCount(0), buildTime(0.0)
+{
+}
+
+// build the set for every cell
+void PotentiallyVisibleSet::build(const WallGrid& walls, float maxDistance, int threadCount, int samplesPerAxis)
+{
+    auto buildStart = chrono::steady_clock::now();
+
+    width = walls.getWidth();
+    height = walls.getHeight();
+    uint32_t cellCount = static_cast<uint32_t>(width) * height;
+    uint32_t blockCount = (cellCount + cellsPerBlock - 1) / cellsPerBlock;
+
+    if (threadCount <= 0) {
+        threadCount = max(1, static_cast<int>(thread::hardware_concurrency()));
+    }
+    samplesPerAxis = max(1, samplesPerAxis);
+
+    // Every block is encoded on its own and stitched together in cell order afterwards
+    vector<vector<uint8_t>> blockData(blockCount);
+    vector<uint32_t> cellBytes(cellCount);
+    vector<uint8_t> incomplete(cellCount, 0);
+    atomic<uint32_t> nextBlock(0);
+
+    auto worker = [&]() {
+        PortalCuller culler;
+        vector<uint32_t> stamp(cellCount, 0);
+        vector<uint32_t> visible;
+
+        for (uint32_t block = nextBlock++; block < blockCount; block = nextBlock++) {
+            uint32_t first = block * cellsPerBlock;
+            uint32_t last = min(cellCount, first + cellsPerBlock);
+            vector<uint8_t>& out = blockData[block];
+
+            for (uint32_t cell = first; cell < last; cell++) {
+                int x = cell % width;
+                int y = cell / width;
+
+                // Union of the full-view portal walks from the sample points, corners and edges included
+                visible.clear();
+                for (int i = 0; i < samplesPerAxis && !incomplete[cell]; i++) {
+                    for (int j = 0; j < samplesPerAxis; j++) {
+                        float u = samplesPerAxis == 1 ? 0.5f : static_cast<float>(i) / (samplesPerAxis - 1);
+                        float v = samplesPerAxis == 1 ? 0.5f : static_cast<float>(j) / (samplesPerAxis - 1);
+                        const vector<uint32_t>& seen = culler.computeVisibleCells(
+                            walls, x + u, y + v, 0.0f, 0.0f, 3.1415927f, maxDistance);
+
+                        // A cut short walk misses cells; the cell keeps no set at all
+                        if (culler.overflowed()) {
+                            incomplete[cell] = 1;
+                            visible.clear();
+                            break;
+                        }
+                        for (uint32_t seenCell : seen) {
+                            if (stamp[seenCell] != cell + 1) {
+                                stamp[seenCell] = cell + 1;
+                                visible.push_back(seenCell);
+                            }
+                        }
+                    }
+                }
+                sort(visible.begin(), visible.end());
+
+                // Run-length encode the bitset: (zeros since last run, length of run) pairs
+                size_t before = out.size();
+                uint32_t position = 0;
+                for (size_t k = 0; k < visible.size();) {
+                    size_t runEnd = k + 1;
+                    while (runEnd < visible.size() && visible[runEnd] == visible[runEnd - 1] + 1) {
+                        runEnd++;
+                    }
+                    appendVarint(out, visible[k] - position);
+                    appendVarint(out, static_cast<uint32_t>(runEnd - k));
+                    position = visible[runEnd - 1] + 1;
+                    k = runEnd;
+                }
+                cellBytes[cell] = static_cast<uint32_t>(out.size() - before);
+            }
+        }
+    };
+
+    vector<thread> workers;
+    for (int t = 1; t < threadCount; t++) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto& w : workers) {
+        w.join();
+    }
+
+    // Stitch the blocks together and build the offset table
+    offsets.assign(static_cast<size_t>(cellCount) + 1, 0);
+    incompleteBits.assign((static_cast<size_t>(cellCount) + 63) / 64, 0);
+    incompleteCount = 0;
+    for (uint32_t cell = 0; cell < cellCount; cell++) {
+        offsets[cell + 1] = offsets[cell] + cellBytes[cell];
+        if (incomplete[cell]) {
+            incompleteBits[cell >> 6] |= uint64_t(1) << (cell & 63);
+            incompleteCount++;
+        }
+    }
+    data.clear();
+    data.reserve(offsets.back());
+    for (auto& block : blockData) {
+        data.insert(data.end(), block.begin(), block.end());
+        vector<uint8_t>().swap(block);
+    }
+
+    auto buildEnd = chrono::steady_clock::now();
+    buildTime = chrono::duration<double, milli>(buildEnd - buildStart).count();
+    cout << "PVS built for " << width << "x" << height << " cells in " << buildTime << " ms on "
+         << threadCount << " threads (" << memoryBytes() / 1024 << " KB)" << endl;
+    if (incompleteCount > 0) {
+        cout << "PVS: " << incompleteCount << " cells hit the portal step budget and draw every wall" << endl;
+    }
+}
+
+// drop the stored set
+void PotentiallyVisibleSet::clear()
+{
+    vector<uint64_t>().swap(offsets);
+    vector<uint8_t>().swap(data);
+    vector<uint64_t>().swap(incompleteBits);
+    incompleteCount = 0;
+}
+
+// decode the cells visible from the given cell
+bool PotentiallyVisibleSet::getVisibleCells(uint32_t cell, vector<uint32_t>& visibleCells) const
+{
+    visibleCells.clear();
+    if (cell + 1 >= offsets.size() || ((incompleteBits[cell >> 6] >> (cell & 63)) & 1u)) {
+        return false;
+    }
+
+    const uint8_t* cursor = data.data() + offsets[cell];
+    const uint8_t* end = data.data() + offsets[cell + 1];
+    auto readVarint = [&]() {
+        uint32_t value = 0;
+        int shift = 0;
+        while (cursor < end) {
+            uint8_t byte = *cursor++;
+            value |= static_cast<uint32_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80))
+                break;
+            shift += 7;
+        }
+        return value;
+    };
+
+    uint32_t position = 0;
+    while (cursor < end) {
+        position += readVarint();
+        uint32_t runLength = readVarint();
+        for (uint32_t i = 0; i < runLength; i++) {
+            visibleCells.push_back(position++);
+        }
+    }
+    return true;
+}
+
+// compressed bytes plus the per-cell offset table
+size_t PotentiallyVisibleSet::memoryBytes() const
+{
+    return data.size() + (offsets.size() + incompleteBits.size()) * sizeof(uint64_t);
+}
+
+void PotentiallyVisibleSet::appendVarint(vector<uint8_t>& out, uint32_t value)
+{
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
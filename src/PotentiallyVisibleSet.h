@@ -0,0 +1,62 @@
+#ifndef POTENTIALLYVISIBLESET_H
+#define POTENTIALLYVISIBLESET_H
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "WallGrid.h"
+
+using namespace std;
+
+// Precomputed potentially visible set (PVS) of a maze.
+// For every cell it stores the cells that can be seen from anywhere inside it,
+// as a run-length compressed bitset over the cell indices (y * width + x): about
+// 31 bytes per cell in a perfect maze, where plain bitsets would take cells² bits
+// (512 MB at 256x256).
+// The set is built by portal walks with a full view from a grid of sample
+// points in each cell; cells are independent, so the build runs on all cores.
+// A cell whose walks ran out of their step budget (mazes with many loops) gets no
+// set; it is marked incomplete and everything has to be drawn from it.
+class PotentiallyVisibleSet
+{
+public:
+    PotentiallyVisibleSet();
+
+    // build the set for every cell; maxDistance is in cells, threadCount 0 uses all cores
+    // samplesPerAxis viewpoints per axis are taken in each cell (samplesPerAxis^2 walks per cell)
+    void build(const WallGrid& walls, float maxDistance, int threadCount = 0, int samplesPerAxis = 4);
+
+    // drop the stored set
+    void clear();
+
+    bool isBuilt() const { return !offsets.empty(); }
+
+    // decode the cells visible from the given cell into visibleCells (sorted, replaces its content);
+    // false when the cell's set is incomplete (or the cell is outside the grid) and nothing may be culled
+    bool getVisibleCells(uint32_t cell, vector<uint32_t>& visibleCells) const;
+
+    // cells whose walks overflowed in the last build
+    size_t getIncompleteCount() const { return incompleteCount; }
+
+    // compressed bytes plus the per-cell offset table
+    size_t memoryBytes() const;
+
+    // time spent in the last build, in milliseconds
+    double getBuildTime() const { return buildTime; }
+
+private:
+    int width;
+    int height;
+    vector<uint64_t> offsets;   // start of each cell's runs in data, width*height+1 entries
+    vector<uint8_t> data;       // varint pairs (zero bits skipped, one bits set) per cell
+    vector<uint64_t> incompleteBits;    // one bit per cell whose walks overflowed
+    size_t incompleteCount;
+    double buildTime;
+
+    static void appendVarint(vector<uint8_t>& out, uint32_t value);
+};
+
+#endif
@@ -0,0 +1,29 @@
+#include "Rng.h"
+
+Rng::Rng(uint64_t seed, Kind kind)
+{
+    this->seed(seed, kind);
+}
+
+// restart the sequence from a seed (expanded into the state with splitmix64)
+void Rng::seed(uint64_t value, Kind kind)
+{
+    this->kind = kind;
+
+    // splitmix64 stream, never yields an all-zero xoshiro state
+    uint64_t x = value;
+    for (auto& word : state) {
+        x += 0x9E3779B97F4A7C15ull;
+        word = mix(x);
+    }
+
+    if (kind == PCG32) {
+        // state[0] is the LCG state, state[1] the (odd) stream increment
+        state[1] = (state[1] << 1) | 1u;
+        uint64_t initial = state[0];
+        state[0] = 0;
+        next32();
+        state[0] += initial;
+        next32();
+    }
+}
@@ -0,0 +1,88 @@
+#ifndef RNG_H
+#define RNG_H
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Small-state pseudo random number generator with a fixed, documented output.
+// Unlike mt19937 with std::uniform_int_distribution (whose mapping to a range is
+// implementation defined), every value here is produced by plain integer arithmetic,
+// so the same seed gives the same sequence on every compiler and platform.
+class Rng
+{
+public:
+    // Generator algorithms
+    enum Kind {
+        XOSHIRO256 = 0,   // xoshiro256** (32 bytes of state)
+        PCG32 = 1         // PCG-XSH-RR 64/32 (16 bytes of state)
+    };
+
+    Rng(uint64_t seed = 0, Kind kind = XOSHIRO256);
+
+    // restart the sequence from a seed (expanded into the state with splitmix64)
+    void seed(uint64_t value, Kind kind);
+    void seed(uint64_t value) { seed(value, kind); }
+
+    Kind getKind() const { return kind; }
+
+    // next 32 random bits
+    uint32_t next32();
+
+    // uniform value in [0, range), range > 0 (Lemire's multiply and reject, no modulo bias)
+    uint32_t bounded(uint32_t range);
+
+    // splitmix64 finalizer, a good 64-bit mixing function for seeds and hashes
+    static uint64_t mix(uint64_t value);
+
+private:
+    Kind kind;
+    uint64_t state[4];
+
+    static uint64_t rotl(uint64_t value, int shift) { return (value << shift) | (value >> (64 - shift)); }
+};
+
+inline uint64_t Rng::mix(uint64_t value)
+{
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+    return value ^ (value >> 31);
+}
+
+inline uint32_t Rng::next32()
+{
+    if (kind == PCG32) {
+        uint64_t old = state[0];
+        state[0] = old * 6364136223846793005ull + state[1];
+        uint32_t xorShifted = static_cast<uint32_t>(((old >> 18) ^ old) >> 27);
+        uint32_t rotation = static_cast<uint32_t>(old >> 59);
+        return (xorShifted >> rotation) | (xorShifted << ((32 - rotation) & 31));
+    }
+
+    uint64_t result = rotl(state[1] * 5, 7) * 9;
+    uint64_t t = state[1] << 17;
+    state[2] ^= state[0];
+    state[3] ^= state[1];
+    state[1] ^= state[2];
+    state[0] ^= state[3];
+    state[2] ^= t;
+    state[3] = rotl(state[3], 45);
+    return static_cast<uint32_t>(result >> 32);
+}
+
+inline uint32_t Rng::bounded(uint32_t range)
+{
+    uint64_t product = static_cast<uint64_t>(next32()) * range;
+    uint32_t low = static_cast<uint32_t>(product);
+    if (low < range) {
+        uint32_t threshold = (0u - range) % range;
+        while (low < threshold) {
+            product = static_cast<uint64_t>(next32()) * range;
+            low = static_cast<uint32_t>(product);
+        }
+    }
+    return static_cast<uint32_t>(product >> 32);
+}
+
+#endif
@@ -0,0 +1,100 @@
+#include "TextureCache.h"
+
+#include <GL/glew.h>
+#include "stb_image.h"
+#include <iostream>
+
+// get the texture for the path, loading it on first use
+unsigned int TextureCache::acquire(const string& path)
+{
+    auto& cache = entries();
+    auto it = cache.find(path);
+    if (it == cache.end()) {
+        it = cache.emplace(path, loadTexture(path)).first;
+    }
+    it->second.refCount++;
+    return it->second.textureID;
+}
+
+// drop one reference to the texture of the path
+void TextureCache::release(const string& path)
+{
+    auto& cache = entries();
+    auto it = cache.find(path);
+    if (it == cache.end()) {
+        cerr << "Released texture that was never acquired: " << path << endl;
+        return;
+    }
+
+    // Free the GL texture once nobody uses it anymore
+    if (--it->second.refCount == 0) {
+        glDeleteTextures(1, &it->second.textureID);
+        cache.erase(it);
+    }
+}
+
+// number of distinct textures currently loaded
+size_t TextureCache::getTextureCount()
+{
+    return entries().size();
+}
+
+// approximate GPU memory used by the loaded textures (including mipmaps)
+size_t TextureCache::getTextureBytes()
+{
+    size_t total = 0;
+    for (const auto& entry : entries()) {
+        total += entry.second.bytes;
+    }
+    return total;
+}
+
+unordered_map<string, TextureCache::Entry>& TextureCache::entries()
+{
+    static unordered_map<string, Entry> cache;
+    return cache;
+}
+
+TextureCache::Entry TextureCache::loadTexture(const string& path)
+{
+    Entry entry = { 0, 0, 0 };
+
+    glGenTextures(1, &entry.textureID);
+    glBindTexture(GL_TEXTURE_2D, entry.textureID);
+
+    // Set texture wrapping
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    // Set texture filtering
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    // Load image
+    int width, height, nrChannels;
+    stbi_set_flip_vertically_on_load(true);
+    unsigned char* data = stbi_load(path.c_str(), &width, &height, &nrChannels, 0);
+    if (data) {
+        GLenum format = GL_RGB;
+        if (nrChannels == 1)
+            format = GL_RED;
+        else if (nrChannels == 3)
+            format = GL_RGB;
+        else if (nrChannels == 4)
+            format = GL_RGBA;
+
+        // Upload texture data to OpenGL
+        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+        glGenerateMipmap(GL_TEXTURE_2D);
+
+        // The mip chain adds roughly a third on top of the base level
+        entry.bytes = static_cast<size_t>(width) * height * nrChannels * 4 / 3;
+
+        cout << "Texture loaded successfully: " << path << endl;
+    }
+    else {
+        cout << "Failed to load texture: " << path << endl;
+    }
+
+    stbi_image_free(data);
+    return entry;
+}
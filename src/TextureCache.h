@@ -0,0 +1,41 @@
+#ifndef TEXTURECACHE_H
+#define TEXTURECACHE_H
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+
+using namespace std;
+
+// Reference-counted registry of GL textures keyed by file path.
+// Each image is decoded and uploaded once; every object that uses it shares
+// the same texture name, which is deleted when the last user releases it.
+class TextureCache
+{
+public:
+    // get the texture for the path, loading it on first use
+    static unsigned int acquire(const string& path);
+
+    // drop one reference to the texture of the path
+    static void release(const string& path);
+
+    // number of distinct textures currently loaded
+    static size_t getTextureCount();
+
+    // approximate GPU memory used by the loaded textures (including mipmaps)
+    static size_t getTextureBytes();
+
+private:
+    struct Entry {
+        unsigned int textureID;
+        int refCount;
+        size_t bytes;
+    };
+
+    static unordered_map<string, Entry>& entries();
+    static Entry loadTexture(const string& path);
+};
+
+#endif
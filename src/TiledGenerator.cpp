@@ -0,0 +1,146 @@
+#include "TiledGenerator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <utility>
+#include <vector>
+
+TiledGenerator::TiledGenerator(MazeGenerator::Algorithm algorithm, int tileSize, int threadCount)
+    : algorithm(algorithm), tileSize(roundTileSize(tileSize)), threadCount(threadCount), scratchBytes(0)
+{
+    if (this->threadCount <= 0) {
+        this->threadCount = max(1u, thread::hardware_concurrency());
+    }
+}
+
+// tile size actually used for a requested one
+int TiledGenerator::roundTileSize(int tileSize)
+{
+    return max(32, (tileSize + 31) / 32 * 32);
+}
+
+// carve the maze into walls (every wall present); rng draws the stitching tree
+void TiledGenerator::generate(WallGrid& walls, uint64_t seed, Rng& rng)
+{
+    int width = walls.getWidth();
+    int height = walls.getHeight();
+    scratchBytes = 0;
+    if (width <= 0 || height <= 0) {
+        return;
+    }
+
+    const int tilesX = (width + tileSize - 1) / tileSize;
+    const int tilesY = (height + tileSize - 1) / tileSize;
+    const size_t tileCount = static_cast<size_t>(tilesX) * tilesY;
+    const int workerCount = static_cast<int>(min(static_cast<size_t>(threadCount), tileCount));
+
+    // Workers take the next tile from a shared counter; each reuses one tile grid and generator
+    atomic<size_t> nextTile(0);
+    vector<size_t> workerScratch(workerCount, 0);
+    auto work = [&](int worker) {
+        WallGrid tile;
+        MazeGenerator* generator = MazeGenerator::create(algorithm);
+        Rng tileRng;
+        size_t peakScratch = 0;
+
+        for (size_t index = nextTile++; index < tileCount; index = nextTile++) {
+            int x0 = static_cast<int>(index % tilesX) * tileSize;
+            int y0 = static_cast<int>(index / tilesX) * tileSize;
+            int tileWidth = min(tileSize, width - x0);
+            int tileHeight = min(tileSize, height - y0);
+
+            tile.resize(tileWidth, tileHeight);
+            tileRng.seed(Rng::mix(seed ^ Rng::mix(index + 1)), rng.getKind());
+            generator->generate(tile, tileRng);
+            peakScratch = max(peakScratch, generator->getScratchBytes() + tile.memoryBytes());
+
+            // The tile's own border walls stay closed; the stitching opens the doors between tiles
+            size_t firstWord = static_cast<size_t>(x0) / 32;
+            for (int y = 0; y < tileHeight; y++) {
+                copy(tile.rowData(y), tile.rowData(y) + tile.getRowWords(), walls.rowData(y0 + y) + firstWord);
+            }
+        }
+
+        delete generator;
+        workerScratch[worker] = peakScratch;
+    };
+
+    if (workerCount == 1) {
+        work(0);
+    }
+    else {
+        vector<thread> workers;
+        for (int worker = 0; worker < workerCount; worker++) {
+            workers.emplace_back(work, worker);
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    stitchTiles(walls, tilesX, tilesY, rng);
+
+    for (size_t bytes : workerScratch) {
+        scratchBytes += bytes;
+    }
+    scratchBytes += tileCount * 2 * sizeof(uint32_t);
+}
+
+// connect the tiles with a random spanning tree (Kruskal over the tile graph), one door per tree edge
+void TiledGenerator::stitchTiles(WallGrid& walls, int tilesX, int tilesY, Rng& rng)
+{
+    int width = walls.getWidth();
+    int height = walls.getHeight();
+    size_t tileCount = static_cast<size_t>(tilesX) * tilesY;
+
+    // Edges packed as tile * 2 + (0 = east neighbour, 1 = south neighbour)
+    vector<uint32_t> edges;
+    for (int ty = 0; ty < tilesY; ty++) {
+        for (int tx = 0; tx < tilesX; tx++) {
+            uint32_t tile = static_cast<uint32_t>(ty) * tilesX + tx;
+            if (tx < tilesX - 1)
+                edges.push_back(tile * 2);
+            if (ty < tilesY - 1)
+                edges.push_back(tile * 2 + 1);
+        }
+    }
+    for (size_t i = edges.size(); i > 1; i--) {
+        swap(edges[i - 1], edges[rng.bounded(static_cast<uint32_t>(i))]);
+    }
+
+    vector<uint32_t> parent(tileCount);
+    for (size_t i = 0; i < tileCount; i++) {
+        parent[i] = static_cast<uint32_t>(i);
+    }
+    auto find = [&](uint32_t tile) {
+        while (parent[tile] != tile) {
+            parent[tile] = parent[parent[tile]];
+            tile = parent[tile];
+        }
+        return tile;
+    };
+
+    for (uint32_t edge : edges) {
+        uint32_t tile = edge >> 1;
+        bool south = edge & 1;
+        uint32_t rootA = find(tile);
+        uint32_t rootB = find(south ? tile + tilesX : tile + 1);
+        if (rootA == rootB) {
+            continue;
+        }
+        parent[rootB] = rootA;
+
+        // A random door along the shared border
+        int x0 = static_cast<int>(tile % tilesX) * tileSize;
+        int y0 = static_cast<int>(tile / tilesX) * tileSize;
+        int tileWidth = min(tileSize, width - x0);
+        int tileHeight = min(tileSize, height - y0);
+        if (south) {
+            walls.removeWall(x0 + static_cast<int>(rng.bounded(tileWidth)), y0 + tileHeight - 1, WallGrid::SOUTH);
+        }
+        else {
+            walls.removeWall(x0 + tileWidth - 1, y0 + static_cast<int>(rng.bounded(tileHeight)), WallGrid::EAST);
+        }
+    }
+}
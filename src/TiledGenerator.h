@@ -0,0 +1,50 @@
+#ifndef TILEDGENERATOR_H
+#define TILEDGENERATOR_H
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "MazeGenerator.h"
+#include "Rng.h"
+#include "WallGrid.h"
+
+using namespace std;
+
+// Parallel maze generation by tiles.
+// The grid is cut into square tiles; worker threads carve an independent perfect maze into
+// each tile with the selected algorithm, and a random spanning tree over the tile graph then
+// opens one door in the border of every pair of tiles it connects, so the whole grid is still
+// a perfect maze. Each tile draws from its own seed derived from the maze seed and the tile
+// index, so the result depends on the seed and tile size but not on the thread count.
+// Tile widths are whole multiples of 32 cells, so tiles own whole words of every row and
+// the workers write straight into the shared grid without locking.
+class TiledGenerator
+{
+public:
+    // tileSize is rounded up to a multiple of 32 cells; threadCount <= 0 uses every core
+    TiledGenerator(MazeGenerator::Algorithm algorithm, int tileSize, int threadCount);
+
+    // carve the maze into walls (every wall present); rng draws the stitching tree
+    void generate(WallGrid& walls, uint64_t seed, Rng& rng);
+
+    int getTileSize() const { return tileSize; }
+    int getThreadCount() const { return threadCount; }
+
+    // scratch memory touched by the last generate, in bytes (the wall grid itself excluded)
+    size_t getScratchBytes() const { return scratchBytes; }
+
+    // tile size actually used for a requested one
+    static int roundTileSize(int tileSize);
+
+private:
+    MazeGenerator::Algorithm algorithm;
+    int tileSize;
+    int threadCount;
+    size_t scratchBytes;
+
+    void stitchTiles(WallGrid& walls, int tilesX, int tilesY, Rng& rng);
+};
+
+#endif
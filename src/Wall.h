@@ -2,27 +2,18 @@
 #define WALL_H
 
 
-#include <GL/glew.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
-#include <glm/gtc/type_ptr.hpp>  // Added for glm::value_ptr
-#include "stb_image.h"  // Local include now available in src directory
-#include <string>
-
-#include "shaders.h"  // Fixed to use quotes for local include
-using namespace std;
 
 #pragma once
 
+// A single wall box of the maze. Walls hold no GL resources of their own,
+// they are baked into a MazeMesh.
 class Wall
 {
 public:
      // Constructor
-    Wall(const glm::vec3& position, const glm::vec3& size, const string& texturePath);
-    
-    // Destructor
-
-    ~Wall();
+    Wall(const glm::vec3& position, const glm::vec3& size);
     
      // Set the position of the wall
      void setPosition(const glm::vec3& position);
@@ -34,23 +25,22 @@ public:
 
     // set the rotation of the wall
     void setRotation(float angle, const glm::vec3& axis);
-    glm::vec3 getRotation() const;
+    float getRotation() const;
 
-    // render the wall
-    void render(shaders* shader, const glm::mat4& view, const glm::mat4& projection);
+    // texture repeat along the wall, merged walls repeat the texture once per cell
+    void setTexScale(const glm::vec2& texScale);
+    glm::vec2 getTexScale() const;
+
+    // model matrix that places the unit cube of this wall in the world
+    glm::mat4 getModelMatrix() const;
 
 private:
-unsigned int VAO, VBO;
-unsigned int textureID;
     glm::vec3 position;
     glm::vec3 size;
-    glm::vec3 color;
 
     float rotationAngle;
-
-    void setupWall();
-    void loadTexture(const string& path);
-    glm::mat4 modelMatrix;
+    glm::vec3 rotationAxis;
+    glm::vec2 texScale;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,145 @@
+#include "WallGrid.h"
+#include "Rng.h"
+
+#include <algorithm>
+
+WallGrid::WallGrid()
+    : width(0), height(0), rowWords(0), northOffset(0), westOffset(0), totalWords(0), words(nullptr)
+{
+}
+
+WallGrid::WallGrid(int width, int height)
+    : WallGrid()
+{
+    resize(width, height);
+}
+
+// copies always own their storage, also when the original is attached to a file
+WallGrid::WallGrid(const WallGrid& other)
+    : WallGrid()
+{
+    *this = other;
+}
+
+WallGrid& WallGrid::operator=(const WallGrid& other)
+{
+    if (this == &other) {
+        return *this;
+    }
+    setLayout(other.width, other.height);
+    owner.reset();
+    lines.assign((totalWords + 7) / 8, CacheLine());
+    words = lines.empty() ? nullptr : lines.front().words;
+    for (auto& line : lines) {
+        for (auto& word : line.words) {
+            word = ~uint64_t(0);
+        }
+    }
+    if (totalWords > 0) {
+        copy(other.data(), other.data() + totalWords, words);
+    }
+    return *this;
+}
+
+void WallGrid::setLayout(int width, int height)
+{
+    this->width = width;
+    this->height = height;
+
+    // two bits per cell, 32 cells per word
+    rowWords = (static_cast<size_t>(width) + 31) / 32;
+    northOffset = rowWords * height;
+    westOffset = northOffset + (static_cast<size_t>(width) + 63) / 64;
+    totalWords = westOffset + (static_cast<size_t>(height) + 63) / 64;
+}
+
+// words a width x height grid needs
+size_t WallGrid::wordCount(int width, int height)
+{
+    return (static_cast<size_t>(width) + 31) / 32 * height + (static_cast<size_t>(width) + 63) / 64 +
+           (static_cast<size_t>(height) + 63) / 64;
+}
+
+// resize the grid, every wall is present afterwards
+void WallGrid::resize(int width, int height)
+{
+    setLayout(width, height);
+
+    owner.reset();
+    lines.clear();
+    lines.resize((totalWords + 7) / 8);
+    words = lines.empty() ? nullptr : lines.front().words;
+    fill(true);
+}
+
+// use external words as the storage, owner keeps them alive
+void WallGrid::attach(uint64_t* words, int width, int height, shared_ptr<void> owner)
+{
+    setLayout(width, height);
+
+    lines.clear();
+    lines.shrink_to_fit();
+    this->words = words;
+    this->owner = owner;
+}
+
+// set every wall (including the boundary) to present or absent
+void WallGrid::fill(bool present)
+{
+    uint64_t value = present ? ~uint64_t(0) : 0;
+    if (owner) {
+        std::fill(words, words + totalWords, value);
+        return;
+    }
+    for (auto& line : lines) {
+        for (auto& word : line.words) {
+            word = value;
+        }
+    }
+}
+
+// add or remove the given wall of cell (x, y)
+void WallGrid::setWall(int x, int y, Direction direction, bool present)
+{
+    switch (direction) {
+    case EAST:
+        setBit(y * rowWords + (x >> 5), (x & 31) * 2, present);
+        break;
+    case SOUTH:
+        setBit(y * rowWords + (x >> 5), (x & 31) * 2 + 1, present);
+        break;
+    case NORTH:
+        if (y == 0)
+            setBit(northOffset + (x >> 6), x & 63, present);
+        else
+            setBit((y - 1) * rowWords + (x >> 5), (x & 31) * 2 + 1, present);
+        break;
+    case WEST:
+        if (x == 0)
+            setBit(westOffset + (y >> 6), y & 63, present);
+        else
+            setBit(y * rowWords + ((x - 1) >> 5), ((x - 1) & 31) * 2, present);
+        break;
+    }
+}
+
+// bytes used by the wall storage
+size_t WallGrid::memoryBytes() const
+{
+    return owner ? totalWords * sizeof(uint64_t) : lines.size() * sizeof(CacheLine);
+}
+
+// hash of every wall bit, equal grids hash equal on every platform
+uint64_t WallGrid::hash() const
+{
+    // Works on word values, not bytes, so it does not depend on endianness.
+    // The words up to the next whole cache line count as set, however the storage is padded
+    uint64_t value = Rng::mix(static_cast<uint64_t>(width) << 32 | static_cast<uint32_t>(height));
+    for (size_t i = 0; i < totalWords; i++) {
+        value = Rng::mix(value ^ data()[i]);
+    }
+    for (size_t i = totalWords; i % 8 != 0; i++) {
+        value = Rng::mix(value ^ ~uint64_t(0));
+    }
+    return value;
+}
@@ -0,0 +1,131 @@
+#ifndef WALLGRID_H
+#define WALLGRID_H
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+// Bit-packed wall storage for a width x height maze.
+// Every shared wall is stored once: each cell owns its east and south edge
+// (two bits per cell, rows padded to whole 64-bit words), and the north and
+// west boundary edges are kept in two small bit rows of their own.
+// The bits normally live in the grid's own cache-line aligned storage, but a grid can also
+// be attached to words owned by someone else (a memory-mapped maze file); copies of such a
+// grid always get storage of their own.
+class WallGrid
+{
+public:
+    // Wall directions, same order as the old per-cell walls[4] array
+    enum Direction {
+        NORTH = 0,
+        SOUTH = 1,
+        WEST = 2,
+        EAST = 3
+    };
+
+    WallGrid();
+    WallGrid(int width, int height);
+    WallGrid(const WallGrid& other);
+    WallGrid(WallGrid&& other) = default;
+    WallGrid& operator=(const WallGrid& other);
+    WallGrid& operator=(WallGrid&& other) = default;
+
+    // resize the grid, every wall is present afterwards
+    void resize(int width, int height);
+
+    // use external words (wordCount(width, height) of them, laid out like this grid's own) as the
+    // storage; owner keeps them alive for as long as the grid uses them
+    void attach(uint64_t* words, int width, int height, shared_ptr<void> owner);
+    bool isAttached() const { return owner != nullptr; }
+
+    // set every wall (including the boundary) to present or absent
+    void fill(bool present);
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+    // check if the given wall of cell (x, y) is present
+    bool hasWall(int x, int y, Direction direction) const;
+
+    // add or remove the given wall of cell (x, y); shared walls update both neighbours
+    void setWall(int x, int y, Direction direction, bool present);
+    void removeWall(int x, int y, Direction direction) { setWall(x, y, direction, false); }
+
+    // 64-bit words of east/south bits per row, and the words of row y (cell x at bits 2x and 2x + 1
+    // of word x / 32); lets row-at-a-time generators and file I/O work on whole rows
+    size_t getRowWords() const { return rowWords; }
+    uint64_t* rowData(int y) { return data() + y * rowWords; }
+    const uint64_t* rowData(int y) const { return data() + y * rowWords; }
+
+    // every word of the grid: the rows, then the north and the west boundary bits
+    const uint64_t* wordData() const { return data(); }
+    size_t getWordCount() const { return totalWords; }
+
+    // words a width x height grid needs
+    static size_t wordCount(int width, int height);
+
+    // bytes used by the wall storage
+    size_t memoryBytes() const;
+
+    // hash of every wall bit, equal grids hash equal on every platform
+    uint64_t hash() const;
+
+private:
+    // storage is allocated in whole cache lines so rows never straddle an allocation
+    struct alignas(64) CacheLine {
+        uint64_t words[8];
+    };
+
+    int width;
+    int height;
+    size_t rowWords;       // 64-bit words per row of east/south bits
+    size_t northOffset;    // word offset of the north boundary bits
+    size_t westOffset;     // word offset of the west boundary bits
+    size_t totalWords;
+    vector<CacheLine> lines;
+    uint64_t* words;            // lines, or the attached storage
+    shared_ptr<void> owner;     // keeps attached storage alive, null for own storage
+
+    uint64_t* data() { return words; }
+    const uint64_t* data() const { return words; }
+
+    void setLayout(int width, int height);
+
+    bool getBit(size_t word, unsigned bit) const { return (data()[word] >> bit) & 1u; }
+    void setBit(size_t word, unsigned bit, bool value);
+};
+
+inline bool WallGrid::hasWall(int x, int y, Direction direction) const
+{
+    switch (direction) {
+    case EAST:
+        return getBit(y * rowWords + (x >> 5), (x & 31) * 2);
+    case SOUTH:
+        return getBit(y * rowWords + (x >> 5), (x & 31) * 2 + 1);
+    case NORTH:
+        if (y == 0)
+            return getBit(northOffset + (x >> 6), x & 63);
+        return getBit((y - 1) * rowWords + (x >> 5), (x & 31) * 2 + 1);
+    case WEST:
+        if (x == 0)
+            return getBit(westOffset + (y >> 6), y & 63);
+        return getBit(y * rowWords + ((x - 1) >> 5), ((x - 1) & 31) * 2);
+    }
+    return true;
+}
+
+inline void WallGrid::setBit(size_t word, unsigned bit, bool value)
+{
+    uint64_t mask = uint64_t(1) << bit;
+    if (value)
+        data()[word] |= mask;
+    else
+        data()[word] &= ~mask;
+}
+
+#endif
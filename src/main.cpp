@@ -10,8 +10,21 @@
 #include "shaders.h"
 #include "maze.h"
 #include "Wall.h"
-
+#include "CameraPath.h"
+#ifdef MAZE_HEADLESS
+#include "HeadlessContext.h"
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <future>
 #include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
 
 // global variables
 GLFWwindow* window;
@@ -22,6 +35,13 @@ maze* Maze = nullptr;
 float lastFrame = 0.0f;
 float deltaTime = 0.0f;
 
+// Radius of the camera's body when walking, in world units
+const float cameraRadius = 0.05f;
+
+// Size of the render target, used for the projection aspect ratio
+int viewportWidth = 800;
+int viewportHeight = 600;
+
 // Mouse input handling variables
 bool firstMouse = true;
 float lastX = 400.0f;
@@ -32,10 +52,13 @@ void configureGLFW();
 int initGLFW();
 int initGLEW();
 int configureWindow();
+void configureRenderState();
 void processInput(GLFWwindow *window);
-void renderScene();
-void setupMaze();
+void renderScene(float timeValue);
+void setupMaze(int mazeWidth, int mazeHeight, bool withPVS, uint64_t seed, MazeGenerator::Algorithm algorithm,
+               const string& mazeFile = "");
 void setupShaders();
+int runHeadless(int argc, char** argv);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 
@@ -102,9 +125,6 @@ void processInput(GLFWwindow *window) {
     deltaTime = currentFrame - lastFrame;
     lastFrame = currentFrame;   
 
-    // Store original position to revert to if collision occurs
-    glm::vec3 originalPosition = camera.Position;
-    
     // Adjust movement speed
     float cameraSpeed = 2.0f * deltaTime;
     
@@ -158,39 +178,74 @@ void processInput(GLFWwindow *window) {
     }
     else {
         // Regular maze movement (constrained to XZ plane)
+        glm::vec3 front = camera.Front;
+        front.y = 0.0f;
+        front = glm::normalize(front);
+        glm::vec3 right = glm::normalize(glm::cross(camera.Front, camera.Up));
+        glm::vec3 movement(0.0f);
+
         // Move forward
         if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) {
-            // Calculate forward movement in XZ plane only
-            glm::vec3 front = camera.Front;
-            front.y = 0.0f; 
-            front = glm::normalize(front); 
-            camera.Position += front * cameraSpeed;
+            movement += front * cameraSpeed;
         }
         // Move backward
         if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS) {
-            glm::vec3 front = camera.Front;
-            front.y = 0.0f;
-            front = glm::normalize(front);
-            camera.Position -= front * cameraSpeed;
+            movement -= front * cameraSpeed;
         }
         // Move left
         if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS) {
-            camera.Position -= glm::normalize(glm::cross(camera.Front, camera.Up)) * cameraSpeed;
+            movement -= right * cameraSpeed;
         }
         // Move right
         if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS) {
-            camera.Position += glm::normalize(glm::cross(camera.Front, camera.Up)) * cameraSpeed;
+            movement += right * cameraSpeed;
         }
-        
-        // Check collision and revert position if needed
-        if (Maze && Maze->checkCollision(camera.Position)) {
-            camera.Position = originalPosition;
+
+        // Sweep the move against the walls and slide along them instead of stopping dead
+        if (Maze) {
+            camera.Position = Maze->moveBody(camera.Position, movement, cameraRadius);
+        } else {
+            camera.Position += movement;
         }
         
         // Keep camera at consistent eye height in regular mode
         camera.Position.y = 0.5f;
     }
     
+    // Cycle wall culling (off, portal walk, precomputed PVS) with C key
+    static bool cKeyPressed = false;
+    if (glfwGetKey(window, GLFW_KEY_C) == GLFW_PRESS) {
+        if (!cKeyPressed && Maze) {
+            static const char* modeNames[] = { "OFF", "PORTAL", "PVS" };
+            maze::VisibilityMode mode = static_cast<maze::VisibilityMode>((Maze->getVisibilityMode() + 1) % 3);
+            Maze->setVisibilityMode(mode);
+            std::cout << "Wall culling: " << modeNames[mode] << std::endl;
+        }
+        cKeyPressed = true;
+    } else {
+        cKeyPressed = false;
+    }
+
+    // Print which way the exit is with H
+    static bool hKeyPressed = false;
+    if (glfwGetKey(window, GLFW_KEY_H) == GLFW_PRESS) {
+        if (!hKeyPressed && Maze) {
+            glm::vec3 direction;
+            unsigned int distance;
+            if (Maze->getExitHint(camera.Position, direction, distance)) {
+                const char* heading = direction.z < 0.0f ? "north" : direction.z > 0.0f ? "south"
+                                    : direction.x < 0.0f ? "west" : "east";
+                std::cout << "Exit: " << distance << " cells away, head " << heading << std::endl;
+            }
+            else {
+                std::cout << "Exit: no hint from here" << std::endl;
+            }
+        }
+        hKeyPressed = true;
+    } else {
+        hKeyPressed = false;
+    }
+
     // Reset position if R is pressed
     if (glfwGetKey(window, GLFW_KEY_R) == GLFW_PRESS) {
         camera.Position = Maze->getPosition();
@@ -198,17 +253,37 @@ void processInput(GLFWwindow *window) {
     }
 }
 
-void setupMaze(){
+void setupMaze(int mazeWidth, int mazeHeight, bool withPVS, uint64_t seed, MazeGenerator::Algorithm algorithm,
+               const string& mazeFile){
     
+    float cellSize = 1.0f;
+
+    // A maze file is mapped instead of generated (its size, seed and algorithm win)
+    MazeGrid loadedGrid;
+    bool loaded = !mazeFile.empty() && loadedGrid.loadFile(mazeFile);
+    if (!mazeFile.empty() && !loaded) {
+        std::cout << "Could not load " << mazeFile << ", generating a new maze" << std::endl;
+    }
+
+    // Otherwise generate the grid on a worker thread while the shaders compile
+    std::future<MazeGrid> generatedGrid;
+    if (!loaded) {
+        generatedGrid = MazeGrid::generateAsync(mazeWidth, mazeHeight, seed, cellSize, algorithm);
+    }
+
     wallShader = new shaders();
     wallShader->createShader("shaders/wall.vs", "shaders/wall.fs");
- 
-    // Initialize the maze with a larger size for more exploration
-    int mazeWidth = 15;
-    int mazeHeight = 15;
-    float cellSize = 1.0f;
 
-    Maze = new maze(mazeWidth, mazeHeight, cellSize, glm::vec3(0.0f, 0.0f, 0.0f), "assets/brick_wall.png");
+    Maze = new maze(loaded ? std::move(loadedGrid) : generatedGrid.get(), glm::vec3(0.0f, 0.0f, 0.0f), "assets/brick_wall.png");
+
+    // The seed and algorithm reproduce this maze (--seed, --algorithm); the ID keys anything cached for it
+    std::cout << "Maze seed: " << Maze->getSeed() << ", algorithm " << MazeGenerator::getName(Maze->getGrid().getAlgorithm())
+              << " (maze ID " << std::hex << Maze->getMazeId() << std::dec << ")" << std::endl;
+
+    // Precompute per-cell visibility up to the far plane used in renderScene
+    if (withPVS) {
+        Maze->buildPVS(100.0f);
+    }
 
     // Position the maze in the world for the camera
     camera.Position = Maze->getPosition();
@@ -217,9 +292,8 @@ void setupMaze(){
 }
 
 
-void renderScene(){
+void renderScene(float timeValue){
     // Set a nice sky blue gradient background
-    float timeValue = glfwGetTime();
     float blueIntensity = 0.7f + 0.1f * sin(timeValue * 0.2f); // Subtle blue variation over time
     
     // Create gradient sky effect - sky blue at the top, lighter at the horizon
@@ -274,7 +348,7 @@ void renderScene(){
     glClear(GL_DEPTH_BUFFER_BIT);
     
     glm::mat4 view = camera.GetViewMatrix();
-    glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)800 / (float)600, 0.1f, 100.0f);
+    glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)viewportWidth / (float)viewportHeight, 0.1f, 100.0f);
 
     // Render the maze on top of our sky background
     if (Maze){
@@ -315,10 +389,194 @@ void mouse_callback(GLFWwindow* window, double xpos, double ypos) {
 // framebuffer size callback function
 void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
     glViewport(0, 0, width, height);
+    if (width > 0 && height > 0) {
+        viewportWidth = width;
+        viewportHeight = height;
+    }
+}
+
+// GL state shared by the windowed and the headless renderer
+void configureRenderState() {
+    // Enable depth testing with proper parameters
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LESS);
+    
+    // Enable backface culling for better performance and rendering
+    glEnable(GL_CULL_FACE);
+    glCullFace(GL_BACK);
+    glFrontFace(GL_CCW);
+    
+    // Additional rendering settings for better visual quality
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+// Headless benchmark: render a scripted walk along the solution path into an offscreen
+// framebuffer for every maze size and print frame time percentiles.
+// Options: --frames N, --sizes 15,64,256, --resolution 800x600, --culling off|portal|pvs, --seed N,
+//          --algorithm dfs|kruskal|wilson|prim|eller|binary-tree|sidewinder
+int runHeadless(int argc, char** argv) {
+#ifdef MAZE_HEADLESS
+    uint64_t seed = 1;   // fixed by default so runs render the same mazes
+    MazeGenerator::Algorithm algorithm = MazeGenerator::DFS;
+    int frameCount = 600;
+    int warmupFrames = 30;
+    vector<int> sizes = { 15, 64, 256 };
+    int targetWidth = 800;
+    int targetHeight = 600;
+    maze::VisibilityMode mode = maze::VISIBILITY_PORTAL;
+
+    for (int i = 1; i < argc; i++) {
+        string option = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (option == "--frames" && hasValue) {
+            frameCount = max(1, atoi(argv[++i]));
+        }
+        else if (option == "--sizes" && hasValue) {
+            sizes.clear();
+            stringstream list(argv[++i]);
+            string size;
+            while (getline(list, size, ',')) {
+                if (atoi(size.c_str()) > 0)
+                    sizes.push_back(atoi(size.c_str()));
+            }
+        }
+        else if (option == "--resolution" && hasValue) {
+            if (sscanf(argv[++i], "%dx%d", &targetWidth, &targetHeight) != 2 || targetWidth <= 0 || targetHeight <= 0) {
+                std::cout << "Invalid resolution, expected WIDTHxHEIGHT" << std::endl;
+                return -1;
+            }
+        }
+        else if (option == "--culling" && hasValue) {
+            string name = argv[++i];
+            if (name == "off")
+                mode = maze::VISIBILITY_OFF;
+            else if (name == "pvs")
+                mode = maze::VISIBILITY_PVS;
+            else
+                mode = maze::VISIBILITY_PORTAL;
+        }
+        else if (option == "--seed" && hasValue) {
+            seed = strtoull(argv[++i], nullptr, 10);
+        }
+        else if (option == "--algorithm" && hasValue) {
+            if (!MazeGenerator::findAlgorithm(argv[++i], algorithm)) {
+                std::cout << "Unknown algorithm: " << argv[i] << std::endl;
+                return -1;
+            }
+        }
+        else if (option != "--headless") {
+            std::cout << "Unknown option: " << option << std::endl;
+            return -1;
+        }
+    }
+
+    HeadlessContext context;
+    if (context.create(targetWidth, targetHeight) != 0) {
+        std::cout << "Failed to create the headless OpenGL context" << std::endl;
+        return -1;
+    }
+    viewportWidth = targetWidth;
+    viewportHeight = targetHeight;
+    configureRenderState();
+
+    // The camera walks a fixed distance per frame, about walking speed at 60 FPS
+    const float stepPerFrame = 2.0f / 60.0f;
+
+    for (int size : sizes) {
+        setupMaze(size, size, mode == maze::VISIBILITY_PVS, seed, algorithm);
+        Maze->setVisibilityMode(mode);
+        Maze->generatePath();
+
+        CameraPath path;
+        for (const auto& point : Maze->getPathPositions()) {
+            path.addWaypoint(point);
+        }
+
+        vector<double> frameTimes;
+        frameTimes.reserve(frameCount);
+        for (int frame = -warmupFrames; frame < frameCount; frame++) {
+            float yaw = 0.0f;
+            path.sample(max(frame, 0) * stepPerFrame, camera.Position, yaw);
+            camera.Yaw = yaw;
+            camera.Pitch = 0.0f;
+            camera.ProcessMouseMovement(0.0f, 0.0f);
+
+            // glFinish makes the time include the rasterization, not just the command submission
+            auto frameStart = std::chrono::steady_clock::now();
+            context.bind();
+            glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            renderScene(max(frame, 0) / 60.0f);
+            glFinish();
+            auto frameEnd = std::chrono::steady_clock::now();
+
+            if (frame >= 0) {
+                frameTimes.push_back(std::chrono::duration<double, std::milli>(frameEnd - frameStart).count());
+            }
+        }
+
+        // Nearest-rank percentiles
+        sort(frameTimes.begin(), frameTimes.end());
+        auto percentile = [&](double p) {
+            size_t rank = static_cast<size_t>(p / 100.0 * frameTimes.size() + 0.999999);
+            return frameTimes[min(max(rank, size_t(1)), frameTimes.size()) - 1];
+        };
+        double total = 0.0;
+        for (double time : frameTimes) {
+            total += time;
+        }
+
+        std::cout << "Frame times " << size << "x" << size << " (" << frameTimes.size() << " frames, "
+                  << targetWidth << "x" << targetHeight << "): p50 " << percentile(50) << " ms | p95 "
+                  << percentile(95) << " ms | p99 " << percentile(99) << " ms | mean "
+                  << total / frameTimes.size() << " ms | max " << frameTimes.back() << " ms | draw calls "
+                  << Maze->getDrawCallCount() << std::endl;
+
+        delete Maze;
+        Maze = nullptr;
+        delete wallShader;
+        wallShader = nullptr;
+    }
+
+    delete shaderProgram;
+    shaderProgram = nullptr;
+    context.destroy();
+    return 0;
+#else
+    std::cout << "Headless mode is not available in this build (rebuild with make HEADLESS=1)" << std::endl;
+    return -1;
+#endif
 }
 
 
-int main() {
+int main(int argc, char** argv) {
+    // Offscreen benchmark run, no window or input
+    uint64_t seed = MazeGrid::randomSeed();
+    MazeGenerator::Algorithm algorithm = MazeGenerator::DFS;
+    string mazeFile;
+    string saveFile;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--headless") == 0) {
+            return runHeadless(argc, argv) == 0 ? 0 : 1;
+        }
+        if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], nullptr, 10);
+        }
+        if (strcmp(argv[i], "--algorithm") == 0 && i + 1 < argc) {
+            if (!MazeGenerator::findAlgorithm(argv[++i], algorithm)) {
+                std::cout << "Unknown algorithm: " << argv[i] << std::endl;
+                return -1;
+            }
+        }
+        if (strcmp(argv[i], "--maze-file") == 0 && i + 1 < argc) {
+            mazeFile = argv[++i];
+        }
+        if (strcmp(argv[i], "--save-maze") == 0 && i + 1 < argc) {
+            saveFile = argv[++i];
+        }
+    }
+
     // Initialize GLFW
     if (initGLFW() != 0) {
         std::cout << "Failed to initialize GLFW" << std::endl;
@@ -342,20 +600,13 @@ int main() {
         return -1;
     }
 
-    // Enable depth testing with proper parameters
-    glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GL_LESS);
-    
-    // Enable backface culling for better performance and rendering
-    glEnable(GL_CULL_FACE);
-    glCullFace(GL_BACK);
-    glFrontFace(GL_CCW);
-    
-    // Additional rendering settings for better visual quality
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    configureRenderState();
 
-    setupMaze();
+    // Initialize the maze with a larger size for more exploration
+    setupMaze(15, 15, true, seed, algorithm, mazeFile);
+    if (!saveFile.empty() && Maze->getGrid().saveFile(saveFile)) {
+        std::cout << "Maze saved to " << saveFile << std::endl;
+    }
     
     // Set the mouse callback function
     glfwSetCursorPosCallback(window, mouse_callback);
@@ -375,7 +626,8 @@ int main() {
     std::cout << "\n===== MazeGL Controls =====\n";
     std::cout << "Use WASD keys to navigate through the maze." << std::endl;
     std::cout << "Use mouse to look around." << std::endl;
-    std::cout << "Find your way to the exit at the opposite corner!\n" << std::endl;
+    std::cout << "Find your way to the exit at the opposite corner!" << std::endl;
+    std::cout << "Press H for a hint which way the exit is.\n" << std::endl;
     
     std::cout << "===== Free Movement Mode =====\n";
     std::cout << "Press F to toggle free movement mode ON/OFF" << std::endl;
@@ -384,9 +636,14 @@ int main() {
     std::cout << "  - Q/E: Move down/up vertically" << std::endl;
     std::cout << "  - Collisions are disabled for testing purposes\n" << std::endl;
     
+    std::cout << "Press C to cycle wall culling (off / portal / PVS)" << std::endl;
     std::cout << "Press R to reset position" << std::endl;
     std::cout << "Press ESC to exit the application" << std::endl;
     
+    // Frame statistics, logged once per second
+    int framesSinceLog = 0;
+    double lastStatsTime = glfwGetTime();
+
     // Main loop
     while (!glfwWindowShouldClose(window)) {
         glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
@@ -394,7 +651,21 @@ int main() {
         
         processInput(window);
         // Render the scene
-        renderScene();
+        renderScene(static_cast<float>(glfwGetTime()));
+
+        // Log the frame rate and the draw calls per frame
+        framesSinceLog++;
+        double now = glfwGetTime();
+        if (now - lastStatsTime >= 1.0) {
+            std::cout << "FPS: " << framesSinceLog / (now - lastStatsTime)
+                      << " | Draw calls per frame: " << (Maze ? Maze->getDrawCallCount() : 0)
+                      << " | Visible cells: " << (Maze ? Maze->getVisibleCellCount() : 0)
+                      << " | Chunks in view: " << (Maze ? Maze->getVisibleChunkCount() : 0)
+                      << "/" << (Maze ? Maze->getChunkCount() : 0)
+                      << " | Maze render CPU: " << (Maze ? Maze->getRenderCpuTime() : 0.0) << " ms" << std::endl;
+            framesSinceLog = 0;
+            lastStatsTime = now;
+        }
 
         // Swap buffers and poll events
         glfwSwapBuffers(window);
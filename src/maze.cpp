@@ -1,385 +1,394 @@
 #include "maze.h"
+#include "TextureCache.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace {
+
+// Floor directions in WallGrid order (N, S, W, E), north is towards -z
+const glm::vec3 directionVectors[4] = {
+    glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 0.0f, 1.0f),
+    glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f)
+};
+
+// Wall thickness, centered on the grid line
+const float wallThickness = 0.15f;
+
+}
 
 maze::maze(int width, int height, float cellSize, const glm::vec3& position, const string &texturePath)
-    : width(width), height(height), cellSize(cellSize), position(position)
+    : width(width), height(height), cellSize(cellSize), wallHeight(2.0f), position(position), chunkSize(16),
+      grid(width, height, cellSize, position.x, position.z), mesh(nullptr), pathMesh(nullptr),
+      drawCallCount(0), renderCpuTime(0.0), visibilityMode(VISIBILITY_PORTAL), wallFrame(0), visibleCellCount(0),
+      pathIndexTried(false)
 {
-    // Initialize the random number generator
-    rng.seed(static_cast<unsigned int>(time(nullptr)));
-
     // Initialize the maze
-    initliazeMaze();
-    generateMaze();
-    createWalls(texturePath);
-    createFloors("assets/FloorTiles/FloorTilesDeffuse.png"); // Add floor creation with tile texture
+    auto generationStart = chrono::steady_clock::now();
+    grid.generateMaze();
+    auto generationEnd = chrono::steady_clock::now();
+    cout << "Maze " << width << "x" << height << " generated in "
+         << chrono::duration<double, milli>(generationEnd - generationStart).count() << " ms"
+         << " (wall grid: " << grid.getWalls().memoryBytes() / 1024.0 << " KB)" << endl;
+
+    createMesh(texturePath);
+
+    auto constructionEnd = chrono::steady_clock::now();
+    cout << "Maze built in " << chrono::duration<double, milli>(constructionEnd - generationStart).count() << " ms" << endl;
 }
 
-//destructor
-maze::~maze()
+// build the renderable maze from an already generated grid (e.g. from MazeGrid::generateAsync)
+maze::maze(MazeGrid generatedGrid, const glm::vec3& position, const string &texturePath)
+    : width(generatedGrid.getWidth()), height(generatedGrid.getHeight()), cellSize(generatedGrid.getCellSize()),
+      wallHeight(2.0f), position(position), chunkSize(16), grid(std::move(generatedGrid)), mesh(nullptr),
+      pathMesh(nullptr), drawCallCount(0), renderCpuTime(0.0), visibilityMode(VISIBILITY_PORTAL), wallFrame(0),
+      visibleCellCount(0), pathIndexTried(false)
 {
-   for (auto wall : wallObjects){
-         delete wall;
-   }
-   wallObjects.clear();
-   
-   // Clean up floor objects
-   for (auto floor : floorObjects){
-         delete floor;
-   }
-   floorObjects.clear();
-   
-   // Clean up path objects
-   for (auto path : pathObjects){
-         delete path;
-   }
-   pathObjects.clear();
+    grid.setOrigin(position.x, position.z);
+    createMesh(texturePath);
 }
 
-// initialize the maze (the grid)
-void maze::initliazeMaze()
+// Bake walls and floors into one static mesh
+void maze::createMesh(const string &texturePath)
 {
-   // Initialize the visited grid
-   visited.resize(height);
-   for (int i = 0; i < height; ++i) {
-       visited[i].resize(width, false);
-   }
-
-   // Initialize the walls grid
-    walls.resize(height);
-    for (int i = 0; i < height; i++)
-    {
-        walls[i].resize(width);
-        for (int j = 0; j < width; j++)
-        {
-            // All walls are initially present
-            walls[i][j].resize(4, true);
-        }
-    }
+    auto bakeStart = chrono::steady_clock::now();
+    mesh = new MazeMesh();
+    createFloors("assets/FloorTiles/FloorTilesDeffuse.png"); // Add floor creation with tile texture
+    createWalls(texturePath);
+    mesh->upload();
+    auto bakeEnd = chrono::steady_clock::now();
+    cout << "Maze mesh baked in " << chrono::duration<double, milli>(bakeEnd - bakeStart).count() << " ms: "
+         << mesh->getVertexCount() << " vertices, " << mesh->getIndexCount() << " indices ("
+         << mesh->getBufferBytes() / 1024 << " KB) in " << mesh->getChunkCount() << " chunks" << endl;
+
+    // Textures are shared, so this scales with distinct images rather than with walls
+    cout << "Maze textures: " << TextureCache::getTextureCount() << " ("
+         << TextureCache::getTextureBytes() / 1024 << " KB)" << endl;
 }
 
-// generate the maze using Depth-First Search Algorithm
-void maze::generateMaze()
+//destructor
+maze::~maze()
 {
-    // Stack to keep track of the cells
-    stack<pair<int, int>> stack;
-
-    // Initialize the walls to be present
-    for (int i = 0; i < height; i++) {
-        for (int j = 0; j < width; j++) {
-            for (int k = 0; k < 4; k++) {
-                //Set all the walls to true
-                walls[i][j][k] = true; 
-            }
-        }
-    }
+   delete mesh;
+   delete pathMesh;
+}
 
-    // Set a random starting point
-    uniform_int_distribution<int> startX(0, width - 1);
-    uniform_int_distribution<int> startY(0, height - 1);
+// create walls based on the walls grid
+// Adjacent walls along the same grid line are merged into one long box, and
+// every shared wall is emitted once instead of once per neighbouring cell.
+void maze::createWalls(const string &texturePath){
 
-    int startCellX = 0; // Start in top-left corner
-    int startCellY = 0;
+    const WallGrid& walls = grid.getWalls();
 
-    // Mark the starting cell as visited
-    visited[startCellY][startCellX] = true;
-    stack.push({ startCellX, startCellY });
-    
-    // Keep track of how many cells have been visited
-    int visitedCount = 1;
-    int totalCells = width * height;
-    
-    // Direction mappings (N, S, W, E)
-    const vector<pair<int, int>> directions = {
-        {0, -1},  // North
-        {0, 1},   // South
-        {-1, 0},  // West
-        {1, 0}    // East
-    };
-    
-    // Direction to index mapping: N=0, S=1, W=2, E=3
-    const vector<int> dirToIndex = {0, 1, 2, 3};
-
-    // Keep carving passages while there are cells to visit
-    while (!stack.empty()) {
-        // Get the current cell
-        auto [currentX, currentY] = stack.top();
-
-        // Find all unvisited neighbors
-        vector<pair<int, int>> unvisitedNeighbors;
-        for (int d = 0; d < directions.size(); d++) {
-            int nx = currentX + directions[d].first;
-            int ny = currentY + directions[d].second;
-            
-            // Check if neighbor is valid and unvisited
-            if (nx >= 0 && nx < width && ny >= 0 && ny < height && !visited[ny][nx]) {
-                unvisitedNeighbors.push_back({nx, ny});
-            }
-        }
+    // Walls are grouped into square chunks of cells so whole chunks can be frustum culled
+    int chunksX = (width + chunkSize - 1) / chunkSize;
 
-        // If all neighbors are visited, backtrack
-        if (unvisitedNeighbors.empty()) {
-            stack.pop();
-            continue;
-        }
-        
-        // Choose a random unvisited neighbor
-        uniform_int_distribution<int> randomNeighbor(0, unvisitedNeighbors.size() - 1);
-        int randomIndex = randomNeighbor(rng);
-        int nextX = unvisitedNeighbors[randomIndex].first;
-        int nextY = unvisitedNeighbors[randomIndex].second;
-        
-        // Determine direction of movement
-        int dx = nextX - currentX;
-        int dy = nextY - currentY;
-        
-        // Remove walls between current and chosen cells
-        if (dx == 1) {  // Moving East
-            walls[currentY][currentX][3] = false;  // Remove East wall of current
-            walls[nextY][nextX][2] = false;       // Remove West wall of neighbor
-        }
-        else if (dx == -1) {  // Moving West
-            walls[currentY][currentX][2] = false;  // Remove West wall of current
-            walls[nextY][nextX][3] = false;       // Remove East wall of neighbor
-        }
-        else if (dy == 1) {  // Moving South
-            walls[currentY][currentX][1] = false;  // Remove South wall of current
-            walls[nextY][nextX][0] = false;       // Remove North wall of neighbor
-        }
-        else if (dy == -1) {  // Moving North
-            walls[currentY][currentX][0] = false;  // Remove North wall of current
-            walls[nextY][nextX][1] = false;       // Remove South wall of neighbor
-        }
-        
-        // Mark the neighbor as visited
-        visited[nextY][nextX] = true;
-        visitedCount++;
-        
-        // Push the neighbor to the stack
-        stack.push({nextX, nextY});
-    }
+    // Number of unit wall edges and merged boxes, for the merge statistics
+    int edgeCount = 0;
+    int boxCount = 0;
 
-    // Randomly add back walls to make the maze more complex
-    uniform_int_distribution<int> addBackWall(0, 4); 
-    
-    // Make sure entrance and exit are clear
-    walls[0][0][0] = false; // Clear entrance
-    walls[height-1][width-1][1] = false; // Clear exit
-}
+    // (cell, wall) pairs for every cell a wall touches, sorted into cellWallStart/cellWallIds below
+    vector<pair<uint32_t, uint32_t>> cellWalls;
 
+    // Horizontal grid lines: line 0 is the north boundary, line height is the south boundary
+    for (int line = 0; line <= height; line++) {
+        float z = position.z + line * cellSize;
 
-// create walls based on the walls grid
-void maze::createWalls(const string &texturePath){
+        // The edge between row line-1 and row line is the south wall of row line-1
+        auto present = [&](int column) {
+            return line == 0 ? walls.hasWall(column, 0, WallGrid::NORTH)
+                             : walls.hasWall(column, line - 1, WallGrid::SOUTH);
+        };
 
-    float wallHeight = 2.0f; // Increase wall height for better visibility
-    float wallThickness = 0.15f; // Wall thickness
-    float overlap = 0.005f; // Tiny overlap to prevent gaps between walls
-
-    for (int i = 0; i < height; ++i) {
-        for (int j = 0; j < width; ++j) {
-            // Calculate the center position of the current cell
-            float x = position.x + (j * cellSize) + cellSize/2;
-            float y = position.y;
-            float z = position.z + (i * cellSize) + cellSize/2;
-
-            if (walls[i][j][0]) { // North wall
-                Wall* wall = new Wall(
-                    glm::vec3(x, position.y + wallHeight/2, z - cellSize/2 + wallThickness/2 - overlap),
-                    glm::vec3(cellSize + overlap*2, wallHeight, wallThickness), 
-                    texturePath
-                );
-                wallObjects.push_back(wall);
+        int x = 0;
+        while (x < width) {
+            if (!present(x)) {
+                x++;
+                continue;
             }
 
-            if (walls[i][j][1]){ // South wall
-                Wall* wall = new Wall(
-                    glm::vec3(x, position.y + wallHeight/2, z + cellSize/2 - wallThickness/2 + overlap),
-                    glm::vec3(cellSize + overlap*2, wallHeight, wallThickness), 
-                    texturePath
-                );
-                wallObjects.push_back(wall);
-            }
-            
-            if (walls[i][j][2]){ // West wall
-                Wall* wall = new Wall(
-                    glm::vec3(x - cellSize/2 + wallThickness/2 - overlap, position.y + wallHeight/2, z),
-                    glm::vec3(wallThickness, wallHeight, cellSize + overlap*2), 
-                    texturePath
-                );
-                wallObjects.push_back(wall);
+            // Extend the run while the next edge on this line also has a wall, stopping at chunk borders
+            int runStart = x;
+            while (x < width && present(x) && (x == runStart || x % chunkSize != 0)) {
+                x++;
             }
+            int runLength = x - runStart;
+            edgeCount += runLength;
 
-            if (walls[i][j][3]){ // East wall
-                Wall* wall = new Wall(
-                    glm::vec3(x + cellSize/2 - wallThickness/2 + overlap, position.y + wallHeight/2, z),
-                    glm::vec3(wallThickness, wallHeight, cellSize + overlap*2), 
-                    texturePath
-                );
-                wallObjects.push_back(wall);
+            // Extend the box by half a thickness at each end to close the corners
+            Wall wall(
+                glm::vec3(position.x + (runStart + runLength / 2.0f) * cellSize, position.y + wallHeight/2, z),
+                glm::vec3(runLength * cellSize + wallThickness, wallHeight, wallThickness)
+            );
+            wall.setTexScale(glm::vec2(static_cast<float>(runLength), 1.0f));
+            int chunk = (min(line, height - 1) / chunkSize) * chunksX + runStart / chunkSize;
+            uint32_t wallId = mesh->addWall(wall, texturePath, chunk);
+            boxCount++;
+
+            // The wall is seen from the cells on either side of the line
+            for (int column = runStart; column < x; column++) {
+                if (line > 0)
+                    cellWalls.push_back({ static_cast<uint32_t>((line - 1) * width + column), wallId });
+                if (line < height)
+                    cellWalls.push_back({ static_cast<uint32_t>(line * width + column), wallId });
             }
         }
     }
 
-    // Similar adjustments for boundary walls
-    for (int j = 0; j < width; j++){
-        float x = position.x + (j * cellSize) + cellSize/2;
-        
-        if (walls[0][j][0]){ // North boundary wall
-            Wall* wall = new Wall(
-                glm::vec3(x, position.y + wallHeight/2, position.z + overlap),
-                glm::vec3(cellSize + overlap*2, wallHeight, wallThickness),
-                texturePath
-            );
-            wallObjects.push_back(wall);
-        }
-        
-        if (walls[height - 1][j][1]){ // South boundary wall
-            Wall* wall = new Wall(
-                glm::vec3(x, position.y + wallHeight/2, position.z + (height * cellSize) - overlap),
-                glm::vec3(cellSize + overlap*2, wallHeight, wallThickness),
-                texturePath
-            );
-            wallObjects.push_back(wall);
-        }
-    } 
+    // Vertical grid lines: line 0 is the west boundary, line width is the east boundary
+    for (int line = 0; line <= width; line++) {
+        float x = position.x + line * cellSize;
 
-    // Create the left and right boundary walls
-    for (int i = 0; i < height; i++){
-        float z = position.z + (i * cellSize) + cellSize/2;
-        
-        if (walls[i][0][2]){ // West boundary wall
-            Wall* wall = new Wall(
-                glm::vec3(position.x + overlap, position.y + wallHeight/2, z),
-                glm::vec3(wallThickness, wallHeight, cellSize + overlap*2),
-                texturePath
-            );
-            wallObjects.push_back(wall);
-        }
-        
-        if (walls[i][width - 1][3]){ // East boundary wall
-            Wall* wall = new Wall(
-                glm::vec3(position.x + (width * cellSize) - overlap, position.y + wallHeight/2, z),
-                glm::vec3(wallThickness, wallHeight, cellSize + overlap*2),
-                texturePath
+        // The edge between column line-1 and column line is the east wall of column line-1
+        auto present = [&](int row) {
+            return line == 0 ? walls.hasWall(0, row, WallGrid::WEST)
+                             : walls.hasWall(line - 1, row, WallGrid::EAST);
+        };
+
+        int z = 0;
+        while (z < height) {
+            if (!present(z)) {
+                z++;
+                continue;
+            }
+
+            int runStart = z;
+            while (z < height && present(z) && (z == runStart || z % chunkSize != 0)) {
+                z++;
+            }
+            int runLength = z - runStart;
+            edgeCount += runLength;
+
+            Wall wall(
+                glm::vec3(x, position.y + wallHeight/2, position.z + (runStart + runLength / 2.0f) * cellSize),
+                glm::vec3(wallThickness, wallHeight, runLength * cellSize + wallThickness)
             );
-            wallObjects.push_back(wall);
+            wall.setTexScale(glm::vec2(static_cast<float>(runLength), 1.0f));
+            int chunk = (runStart / chunkSize) * chunksX + min(line, width - 1) / chunkSize;
+            uint32_t wallId = mesh->addWall(wall, texturePath, chunk);
+            boxCount++;
+
+            for (int row = runStart; row < z; row++) {
+                if (line > 0)
+                    cellWalls.push_back({ static_cast<uint32_t>(row * width + line - 1), wallId });
+                if (line < width)
+                    cellWalls.push_back({ static_cast<uint32_t>(row * width + line), wallId });
+            }
         }
     }
+
+    // Counting sort of the (cell, wall) pairs into a compact per-cell wall list
+    cellWallStart.assign(static_cast<size_t>(width) * height + 1, 0);
+    for (const auto& cellWall : cellWalls) {
+        cellWallStart[cellWall.first + 1]++;
+    }
+    for (size_t i = 1; i < cellWallStart.size(); i++) {
+        cellWallStart[i] += cellWallStart[i - 1];
+    }
+    cellWallIds.resize(cellWalls.size());
+    vector<uint32_t> fillPosition(cellWallStart.begin(), cellWallStart.end() - 1);
+    for (const auto& cellWall : cellWalls) {
+        cellWallIds[fillPosition[cellWall.first]++] = cellWall.second;
+    }
+    wallStamp.assign(boxCount, 0);
+
+    // Emitting walls per cell produced two boxes for every edge (both neighbours, or cell and boundary pass)
+    cout << "Wall segments: " << edgeCount * 2 << " per-cell boxes, " << edgeCount
+         << " unique edges, merged into " << boxCount << " boxes" << endl;
 }
 
 // Create the floor of the maze
 void maze::createFloors(const string &floorTexturePath) {
     // Create a more visible floor with proper texture tiling
     // Create main floor for the entire maze with more visible texture
-    Floor* mainFloor = new Floor(
+    Floor mainFloor(
         glm::vec3(position.x + (width * cellSize)/2, position.y - 0.01f, position.z + (height * cellSize)/2), // Center of the maze, slightly lower
         glm::vec2(width * cellSize, height * cellSize),                                               // Size of the entire maze
         floorTexturePath
     );
-    floorObjects.push_back(mainFloor);
+    mesh->addFloor(mainFloor);
     
     // Add a final floor for the exit area
-    Floor* exitFloor = new Floor(
+    Floor exitFloor(
         glm::vec3(position.x + (width * cellSize) + cellSize/2, position.y - 0.01f, position.z + (height * cellSize)/2), 
         glm::vec2(cellSize*2, cellSize*2), 
         floorTexturePath
     );
-    floorObjects.push_back(exitFloor);
+    mesh->addFloor(exitFloor);
 }
 
 // check if the position collides with the maze
 bool maze::checkCollision(const glm::vec3& position) const
 {
-    // Reduce collision buffer
-    const float collisionBuffer = 0.12f;
-    
-    // Check if the position is outside the maze
-    if (position.x < this->position.x + collisionBuffer || 
-        position.x > this->position.x + (width * cellSize) - collisionBuffer ||
-        position.z < this->position.z + collisionBuffer || 
-        position.z > this->position.z + (height * cellSize) - collisionBuffer) {
-        return true; // Collision with the maze boundaries
+    return grid.checkCollision(position.x, position.z);
+}
+
+
+// Move a body on the floor with swept collision, sliding along the walls it touches
+glm::vec3 maze::moveBody(const glm::vec3& bodyPosition, const glm::vec3& movement, float radius) const
+{
+    // Keep the body's radius away from the wall faces, not from their center lines
+    float x = bodyPosition.x;
+    float z = bodyPosition.z;
+    grid.moveCircle(x, z, movement.x, movement.z, radius + wallThickness * 0.5f);
+    return glm::vec3(x, bodyPosition.y, z);
+}
+
+// Render the maze
+void maze::render(shaders* shader, const glm::mat4& view, const glm::mat4& projection)
+{
+    auto renderStart = chrono::steady_clock::now();
+
+    // Find the walls that can be seen from the camera's cell; without a usable result
+    // (camera above the walls or outside the maze) every wall is drawn
+    const vector<uint32_t>* wallsToDraw = nullptr;
+    visibleCellCount = width * height;
+    if (visibilityMode != VISIBILITY_OFF && computeVisibleWalls(view, projection)) {
+        wallsToDraw = &visibleWalls;
     }
 
-    // Convert the position to maze coordinates - handle edge cases better
-    int cellX = static_cast<int>((position.x - this->position.x) / cellSize);
-    int cellZ = static_cast<int>((position.z - this->position.z) / cellSize);
-    
-    // Ensure we're within valid cell range
-    if (cellX < 0) cellX = 0;
-    if (cellX >= width) cellX = width - 1;
-    if (cellZ < 0) cellZ = 0;
-    if (cellZ >= height) cellZ = height - 1;
-    
-    // Get local position in the cell with better precision
-    float localX = (position.x - this->position.x) - (cellX * cellSize);
-    float localZ = (position.z - this->position.z) - (cellZ * cellSize);
- 
-    // Check collisions with current cell walls
-    bool collision = false;
-    
-    // North wall collision
-    if (walls[cellZ][cellX][0] && localZ < collisionBuffer) {
-        collision = true;
+    // The floor and the walls are one baked mesh, one draw per texture
+    drawCallCount = mesh->render(shader, view, projection, wallsToDraw);
+
+    // Render path markers on top of the floor
+    if (pathMesh) {
+        drawCallCount += pathMesh->render(shader, view, projection);
     }
-    // South wall collision
-    else if (walls[cellZ][cellX][1] && localZ > cellSize - collisionBuffer) {
-        collision = true;
+
+    auto renderEnd = chrono::steady_clock::now();
+    renderCpuTime = chrono::duration<double, milli>(renderEnd - renderStart).count();
+}
+
+// number of draw calls issued by the last render
+int maze::getDrawCallCount() const
+{
+    return drawCallCount;
+}
+
+// Find the cells visible from the camera (portal walk or PVS lookup) and collect their walls
+bool maze::computeVisibleWalls(const glm::mat4& view, const glm::mat4& projection)
+{
+    // Camera position and forward direction from the inverse view matrix
+    glm::mat4 cameraToWorld = glm::inverse(view);
+    glm::vec3 eye = glm::vec3(cameraToWorld[3]);
+    glm::vec3 forward = -glm::vec3(cameraToWorld[2]);
+
+    // Portals only describe the view from inside the corridors
+    float viewerX = (eye.x - position.x) / cellSize;
+    float viewerZ = (eye.z - position.z) / cellSize;
+    if (viewerX < 0.0f || viewerX >= width || viewerZ < 0.0f || viewerZ >= height ||
+        eye.y < position.y || eye.y > position.y + wallHeight) {
+        return false;
     }
-    // West wall collision
-    else if (walls[cellZ][cellX][2] && localX < collisionBuffer) {
-        collision = true;
+
+    // The precomputed set only needs the camera's cell
+    if (visibilityMode == VISIBILITY_PVS) {
+        if (!pvs.isBuilt()) {
+            return false;
+        }
+        uint32_t cell = static_cast<uint32_t>(viewerZ) * width + static_cast<uint32_t>(viewerX);
+        // A cell whose precomputed walks overflowed has no set, so nothing is culled from it
+        if (!pvs.getVisibleCells(cell, pvsCells)) {
+            return false;
+        }
+        visibleCellCount = static_cast<int>(pvsCells.size());
+        collectWalls(pvsCells);
+        return true;
     }
-    // East wall collision
-    else if (walls[cellZ][cellX][3] && localX > cellSize - collisionBuffer) {
-        collision = true;
+
+    // Horizontal half angle of the frustum footprint. Looking up or down widens it: the
+    // corner rays lean towards the horizontal forward axis by cos(pitch) - tan(fovY/2) * |sin(pitch)|
+    float tanHalfX = 1.0f / projection[0][0];
+    float tanHalfY = 1.0f / projection[1][1];
+    float sinPitch = glm::clamp(forward.y, -1.0f, 1.0f);
+    float cosPitch = sqrt(1.0f - sinPitch * sinPitch);
+    float forwardReach = cosPitch - tanHalfY * fabs(sinPitch);
+    float halfAngle = forwardReach > 0.05f ? atan(tanHalfX / forwardReach) : 3.1415927f;
+
+    // Far plane distance of a perspective projection, in cells
+    float farDistance = projection[3][2] / (projection[2][2] + 1.0f);
+    float maxDistance = fabs(farDistance) / cellSize;
+
+    const vector<uint32_t>& cells = portalCuller.computeVisibleCells(
+        grid.getWalls(), viewerX, viewerZ, forward.x, forward.z, halfAngle, maxDistance);
+    if (portalCuller.overflowed()) {
+        return false;
     }
-    
-    // Check for corner cases - when we're near cell boundaries
-    // This prevents getting stuck at cell corners
-    if (localX < collisionBuffer && localZ < collisionBuffer) {
-        // Near northwest corner - check diagonal cell if it exists
-        if (cellX > 0 && cellZ > 0) {
-            if (walls[cellZ-1][cellX-1][1] || walls[cellZ-1][cellX-1][3]) {
-                collision = true;
-            }
-        }
+    visibleCellCount = static_cast<int>(cells.size());
+    collectWalls(cells);
+    return true;
+}
+
+// Gather the walls around the given cells, each wall once
+void maze::collectWalls(const vector<uint32_t>& cells)
+{
+    if (++wallFrame == 0) {
+        fill(wallStamp.begin(), wallStamp.end(), 0);
+        wallFrame = 1;
     }
-    else if (localX > cellSize - collisionBuffer && localZ < collisionBuffer) {
-        // Near northeast corner
-        if (cellX < width-1 && cellZ > 0) {
-            if (walls[cellZ-1][cellX+1][1] || walls[cellZ-1][cellX+1][2]) {
-                collision = true;
+    visibleWalls.clear();
+    for (uint32_t cell : cells) {
+        for (uint32_t i = cellWallStart[cell]; i < cellWallStart[cell + 1]; i++) {
+            uint32_t wall = cellWallIds[i];
+            if (wallStamp[wall] != wallFrame) {
+                wallStamp[wall] = wallFrame;
+                visibleWalls.push_back(wall);
             }
         }
     }
-    
-    return collision;
 }
 
+// select how walls are culled
+void maze::setVisibilityMode(VisibilityMode mode)
+{
+    visibilityMode = mode;
+}
 
-// Render the maze
-void maze::render(shaders* shader, const glm::mat4& view, const glm::mat4& projection)
+maze::VisibilityMode maze::getVisibilityMode() const
 {
-    // Render all floor tiles first (so they appear below everything)
-    for (auto floor : floorObjects) {
-        floor->render(shader, view, projection);
-    }
-    
-    // Render path markers above the floor but below walls
-    for (auto path : pathObjects) {
-        path->render(shader, view, projection);
-    }
-    
-    // Then render all walls
-    for (auto wall : wallObjects) {
-        wall->render(shader, view, projection);
-    }
+    return visibilityMode;
+}
+
+// precompute the potentially visible set of every cell
+void maze::buildPVS(float maxDistance, int threadCount)
+{
+    pvs.build(grid.getWalls(), maxDistance / cellSize, threadCount);
+}
+
+// number of cells found visible by the last render (all cells when not culling)
+int maze::getVisibleCellCount() const
+{
+    return visibleCellCount;
+}
+
+// render chunks inside the view frustum in the last render
+int maze::getVisibleChunkCount() const
+{
+    return static_cast<int>(mesh->getVisibleChunkCount());
+}
+
+// total number of render chunks
+int maze::getChunkCount() const
+{
+    return static_cast<int>(mesh->getChunkCount());
+}
+
+// CPU time spent in the last render, in milliseconds
+double maze::getRenderCpuTime() const
+{
+    return renderCpuTime;
 }
 
 
 
 // Create visual markers for the path
 void maze::createPathMarkers() {
-    for (const auto& cell : pathCells) {
+    // The markers get their own small baked mesh so the maze mesh never needs rebaking
+    delete pathMesh;
+    pathMesh = new MazeMesh();
+
+    for (const auto& cell : grid.getPathCells()) {
         int x = cell.first;
         int y = cell.second;
         
@@ -389,171 +398,63 @@ void maze::createPathMarkers() {
         float pz = position.z + (y * cellSize) + cellSize/2;
         
         // Create a new floor object with a different color/texture for the path
-        Floor* pathMarker = new Floor(
+        Floor pathMarker(
             glm::vec3(px, py, pz),                    // Centered in the cell
             glm::vec2(cellSize * 0.5f, cellSize * 0.5f),  // Make path markers visible but not too large
             "assets/FloorTiles/FloorTilesSpacular.png"    // Use a different texture for path
         );
         
-        // Add the path marker to the pathObjects vector
-        pathObjects.push_back(pathMarker);
+        // Bake the path marker into the path mesh
+        pathMesh->addFloor(pathMarker);
     }
     
     // Create a special marker for the goal/exit
-    if (!pathCells.empty()) {
+    if (!grid.getPathCells().empty()) {
         // Get the end position (exit)
         float exitX = position.x + (width-1) * cellSize + cellSize/2;
         float exitY = position.y + 0.03f; // Slightly higher than path markers
         float exitZ = position.z + (height-1) * cellSize + cellSize/2;
         
         // Create a prominent marker for the exit
-        Floor* exitMarker = new Floor(
+        Floor exitMarker(
             glm::vec3(exitX, exitY, exitZ),
             glm::vec2(cellSize * 0.7f, cellSize * 0.7f), // Larger than path markers
             "assets/FloorTiles/FloorTilesNormal.png"  // Different texture for the exit
         );
         
-        pathObjects.push_back(exitMarker);
+        pathMesh->addFloor(exitMarker);
     }
+
+    pathMesh->upload();
 }
 
-// Generate a path from start to end with randomized depth-first search algorithm
+// Generate the shortest path from start to end with breadth-first search
 void maze::generatePath() {
-    // Clear any existing path
-    pathCells.clear();
-    for (auto path : pathObjects) {
-        delete path;
-    }
-    pathObjects.clear();
-    
-    // Get start and end cell indices
-    int startX = 0;
-    int startY = 0;
-    int endX = width - 1;
-    int endY = height - 1;
-    
-    // Reset visited cells for pathfinding
-    vector<vector<bool>> pathVisited(height, vector<bool>(width, false));
-    
-    // Create a stack for the depth-first search for the floor
-    stack<pair<int, int>> pathStack;
-    
-    // Create a map to store the path from start to end
-    vector<vector<pair<int, int>>> parent(height, vector<pair<int, int>>(width, {-1, -1}));
-    
-    // Start DFS from the start cell
-    pathVisited[startY][startX] = true;
-    pathStack.push({startX, startY});
-    
-    // Define directions (N, S, W, E)
-    const int numDirections = 4;
-    const int dx[numDirections] = {0, 0, -1, 1};  // x-offset for N, S, W, E
-    const int dy[numDirections] = {-1, 1, 0, 0};  // y-offset for N, S, W, E
-    
-    bool foundPath = false;
-    
-    // Randomized DFS to find a path
-    while (!pathStack.empty() && !foundPath) {
-        // Get the current cell
-        auto current = pathStack.top();
-        int x = current.first;
-        int y = current.second;
-        pathStack.pop();
-        
-        // Check if we've reached the end
-        if (x == endX && y == endY) {
-            foundPath = true;
-            break;
-        }
-        
-        // Get all valid neighbors
-        vector<pair<int, int>> neighbors;
+    delete pathMesh;
+    pathMesh = nullptr;
 
-        for (int dir = 0; dir < numDirections; dir++) {
-            // Skip if there's a wall in this direction
-            if (walls[y][x][dir]) {
-                continue;
-            }
-            
-            int nx = x + dx[dir];
-            int ny = y + dy[dir];
-            
-            // Check if neighbor is valid and not visited
-            if (nx >= 0 && nx < width && ny >= 0 && ny < height && !pathVisited[ny][nx]) {
-                neighbors.push_back({nx, ny});
-            }
-        }
-        
-        // If we have unvisited neighbors, choose one randomly
-        if (!neighbors.empty()) {
-            // Randomly shuffle the neighbors to ensure randomness
-            std::shuffle(neighbors.begin(), neighbors.end(), rng);
-            
-            for (const auto& neighbor : neighbors) {
-                int nx = neighbor.first;
-                int ny = neighbor.second;
-                pathVisited[ny][nx] = true;
-                parent[ny][nx] = {x, y};
-                pathStack.push({nx, ny});
-            }
-        }
+    bool connected = grid.generatePath();
+
+    // Create visual markers for the path
+    createPathMarkers();
+
+    if (connected) {
+        cout << "Shortest path found with " << grid.getPathCells().size() << " cells" << endl;
     }
-    
-    // If we found a path, trace back from end to start
-    if (foundPath) {
-        int x = endX;
-        int y = endY;
-        
-        while (!(x == startX && y == startY)) {
-            pathCells.push_back({x, y});
-            auto parent_cell = parent[y][x];
-            x = parent_cell.first;
-            y = parent_cell.second;
-        }
-        
-        // Add the start cell
-        pathCells.push_back({startX, startY});
-        
-        // Reverse path to go from start to end
-        std::reverse(pathCells.begin(), pathCells.end());
-        
-        // Create visual markers for the path
-        createPathMarkers();
-        
-        cout << "Random path generated with " << pathCells.size() << " cells" << endl;
-    } else {
-        cout << "No path found from start to end" << endl;
-        
-        // Create a direct path by breaking walls
-        createDirectPath(startX, startY, endX, endY);
-        
-        // Try path generation again
-        generatePath();
+    else {
+        // No path through the maze, so walls were broken along a direct route from start to exit
+        cout << "Direct path created with " << grid.getPathCells().size() << " cells (walls broken)" << endl;
     }
 }
 
-// Helper function to create a direct path by breaking walls
-void maze::createDirectPath(int startX, int startY, int endX, int endY) {
-    int x = startX;
-    int y = startY;
-    
-    // Move horizontally first
-    while (x < endX) {
-        // Remove the east wall of the current cell
-        walls[y][x][3] = false;
-        // Remove the west wall of the next cell
-        walls[y][x+1][2] = false;
-        x++;
-    }
-    
-    // Then move vertically
-    while (y < endY) {
-        // Remove the south wall of the current cell
-        walls[y][x][1] = false;
-        // Remove the north wall of the cell below
-        walls[y+1][x][0] = false;
-        y++;
-    }
+// seed of the maze
+uint64_t maze::getSeed() const {
+    return grid.getSeed();
+}
+
+// ID of the maze (seed, size and generator), for keying cached data
+uint64_t maze::getMazeId() const {
+    return grid.getMazeId();
 }
 
 // Return the starting position of the maze
@@ -572,6 +473,103 @@ glm::vec3 maze::getEndPosition() const {
     );
 }
 
+// Return the direction toward the exit and the number of cells left, from the exit distance field
+bool maze::getExitHint(const glm::vec3& worldPosition, glm::vec3& direction, unsigned int& distance) {
+    // The field is only built once a hint is asked for, not for every maze
+    if (!grid.getExitField().isBuilt()) {
+        grid.buildExitField();
+    }
+
+    int cellX;
+    int cellY;
+    WallGrid::Direction step;
+    if (!grid.worldToCell(worldPosition.x, worldPosition.z, cellX, cellY) ||
+        !grid.exitDirection(worldPosition.x, worldPosition.z, step)) {
+        return false;
+    }
+
+    direction = directionVectors[step];
+    distance = grid.getExitField().getDistance(cellX, cellY);
+    return true;
+}
+
+// Steering direction toward a target cell from its cached flow field
+bool maze::getFlowDirection(const glm::vec3& worldPosition, int targetX, int targetY, glm::vec3& direction) {
+    int cellX;
+    int cellY;
+    const uint8_t* field = grid.getFlowField(targetX, targetY);
+    if (!field || !grid.worldToCell(worldPosition.x, worldPosition.z, cellX, cellY)) {
+        return false;
+    }
+    uint8_t step = field[cellY * grid.getWidth() + cellX];
+    if (step >= FlowFieldCache::atTarget) {
+        return false;
+    }
+    direction = directionVectors[step];
+    return true;
+}
+
+// Path lengths between pairs of world positions, through the grid's path index when it has one
+void maze::getPathLengths(const vector<glm::vec3>& from, const vector<glm::vec3>& to, vector<unsigned int>& lengths) {
+    size_t count = min(from.size(), to.size());
+    uint32_t outside = static_cast<uint32_t>(grid.getWidth() * grid.getHeight());
+
+    // Positions outside the maze get a cell index past the grid, which has no path
+    vector<uint32_t> fromCells(count);
+    vector<uint32_t> toCells(count);
+    for (size_t i = 0; i < count; i++) {
+        int cellX;
+        int cellY;
+        fromCells[i] = grid.worldToCell(from[i].x, from[i].z, cellX, cellY) ? cellY * grid.getWidth() + cellX : outside;
+        toCells[i] = grid.worldToCell(to[i].x, to[i].z, cellX, cellY) ? cellY * grid.getWidth() + cellX : outside;
+    }
+
+    // Index a perfect maze on the first batch; a maze with loops keeps searching each pair
+    if (!pathIndexTried) {
+        pathIndexTried = true;
+        grid.buildPathIndex();
+    }
+
+    lengths.resize(count);
+    grid.pathLengths(fromCells.data(), toCells.data(), count, lengths.data());
+}
+
+// Eye-level positions of the path cells between two world positions
+bool maze::getPath(const glm::vec3& from, const glm::vec3& to, vector<glm::vec3>& path) {
+    path.clear();
+    int startX, startY, endX, endY;
+    vector<pair<int, int>> cells;
+    if (!grid.worldToCell(from.x, from.z, startX, startY) || !grid.worldToCell(to.x, to.z, endX, endY) ||
+        !grid.findPath(startX, startY, endX, endY, cells)) {
+        return false;
+    }
+
+    path.reserve(cells.size());
+    for (const auto& cell : cells) {
+        path.push_back(glm::vec3(
+            position.x + cell.first * cellSize + cellSize/2,
+            position.y + 0.5f,
+            position.z + cell.second * cellSize + cellSize/2
+        ));
+    }
+    return true;
+}
+
+// Return the eye-level positions of the path cells, from start to end
+vector<glm::vec3> maze::getPathPositions() const {
+    vector<glm::vec3> positions;
+    const vector<pair<int, int>>& pathCells = grid.getPathCells();
+    positions.reserve(pathCells.size());
+    for (const auto& cell : grid.getPathCells()) {
+        positions.push_back(glm::vec3(
+            position.x + cell.first * cellSize + cellSize/2,
+            position.y + 0.5f,
+            position.z + cell.second * cellSize + cellSize/2
+        ));
+    }
+    return positions;
+}
+
 
 
 
@@ -12,6 +12,11 @@
 #include <iostream>
 
 #include "Wall.h"
+#include "MazeMesh.h"
+#include "PortalCuller.h"
+#include "PotentiallyVisibleSet.h"
+#include "MazeGrid.h"
+#include "WallGrid.h"
 #include "Floor.h"  // Added Floor header
 #include "shaders.h"
 
@@ -21,20 +26,93 @@ using namespace std;
 class maze
 {
 public:
+    // How the walls to draw are chosen each frame
+    enum VisibilityMode {
+        VISIBILITY_OFF,     // draw every wall
+        VISIBILITY_PORTAL,  // portal walk from the camera every frame
+        VISIBILITY_PVS      // lookup in the precomputed potentially visible set
+    };
+
     maze(int width, int height, float cellSize, const glm::vec3& position, const string &texturePath ="../assets/brick_wall.png");
+
+    // build the renderable maze from an already generated grid (e.g. from MazeGrid::generateAsync)
+    maze(MazeGrid generatedGrid, const glm::vec3& position, const string &texturePath ="../assets/brick_wall.png");
     ~maze();
 
+    // seed and ID of the maze, see MazeGrid
+    uint64_t getSeed() const;
+    uint64_t getMazeId() const;
+
+    // the CPU-side maze (walls, seed, generator), e.g. to save it with MazeGrid::saveFile
+    const MazeGrid& getGrid() const { return grid; }
+
     // starting position of the maze
     glm::vec3 getPosition() const;
 
     // Ending position of the maze
     glm::vec3 getEndPosition() const;
 
+    // eye-level positions of the path cells from start to end (empty until generatePath)
+    vector<glm::vec3> getPathPositions() const;
+
+    // which way to the exit from a world position (a unit vector on the floor) and how many
+    // cells away it is; constant time after the first call builds the exit distance field,
+    // false at the exit or outside the maze
+    bool getExitHint(const glm::vec3& position, glm::vec3& direction, unsigned int& distance);
+
+    // path lengths in cells between pairs of world positions, for many agents at once; lengths[i] is
+    // MazeTree::unreachable when from[i] or to[i] lies outside the maze. The first call indexes a
+    // perfect maze, which then answers each pair without searching
+    void getPathLengths(const vector<glm::vec3>& from, const vector<glm::vec3>& to, vector<unsigned int>& lengths);
+
+    // eye-level positions of the path cells between two world positions, false when there is none
+    bool getPath(const glm::vec3& from, const glm::vec3& to, vector<glm::vec3>& path);
+
+    // paths for a batch of (start, goal) cell requests, e.g. every agent of a simulation tick;
+    // agents sharing a goal share one search, and the paths come back as compact step directions
+    // without touching the path markers. Valid until the next call
+    const PathBatch& solvePaths(const PathRequest* requests, size_t count) { return grid.solvePaths(requests, count); }
+
+    // steering direction for an agent at a world position toward a target cell: one lookup in the
+    // target's cached flow field; false at the target, outside the maze or when it cannot be reached
+    bool getFlowDirection(const glm::vec3& position, int targetX, int targetY, glm::vec3& direction);
+
+    // flow field toward a target cell for steering a whole crowd, one direction byte per cell
+    const uint8_t* getFlowField(int targetX, int targetY) { return grid.getFlowField(targetX, targetY); }
+
+    // memory bound of the cached flow fields, in bytes (one per cell and field)
+    void setFlowFieldBudget(size_t bytes) { grid.setFlowFieldBudget(bytes); }
+
     // check if the position collides with the maze
     bool checkCollision(const glm::vec3& position) const;
 
+    // where a body of the given radius ends up after moving by movement (only x and z are used):
+    // the move is swept against the walls so it cannot pass through them however fast it is,
+    // and slides along a wall it runs into instead of stopping
+    glm::vec3 moveBody(const glm::vec3& position, const glm::vec3& movement, float radius) const;
+
     // render the maze
     void render(shaders* shader, const glm::mat4& view, const glm::mat4& projection);
+
+    // number of draw calls issued by the last render
+    int getDrawCallCount() const;
+
+    // CPU time spent in the last render, in milliseconds
+    double getRenderCpuTime() const;
+
+    // select how walls are culled (the PVS mode needs buildPVS first)
+    void setVisibilityMode(VisibilityMode mode);
+    VisibilityMode getVisibilityMode() const;
+
+    // precompute the potentially visible set of every cell; maxDistance is in world units
+    void buildPVS(float maxDistance, int threadCount = 0);
+
+    // number of cells found visible by the last render (all cells when not culling)
+    int getVisibleCellCount() const;
+
+    // render chunks inside the view frustum in the last render, and in total
+    int getVisibleChunkCount() const;
+    int getChunkCount() const;
     
     // New method to generate a path from start to end
     void generatePath();
@@ -44,34 +122,47 @@ private:
 int width;
 int height;
 float cellSize;
+float wallHeight;
 glm::vec3 position; 
+int chunkSize;  // cells per side of a render chunk
+
+// Walls, generation, path finding and collision (no GL resources)
+MazeGrid grid;
 
-// To track the visited cells during maze generation
-vector <vector<bool>> visited;
+// run-length compressed visible cells of every cell, empty until buildPVS
+PotentiallyVisibleSet pvs;
 
-//2d grid to track walls
-vector<vector<vector<bool>>> walls;
+// Walls and floors baked into one static world-space mesh
+MazeMesh* mesh;
 
-// Wall objects to render the maze
-vector<Wall*> wallObjects;
+// Markers along the path from start to end point
+MazeMesh* pathMesh;  // Path markers, rebaked whenever the path changes
 
-// Floor objects for the maze floor
-vector<Floor*> floorObjects;  // Added floor objects
+// draw calls and CPU time of the last render
+int drawCallCount;
+double renderCpuTime;
 
-// Path from start to end point
-vector<pair<int, int>> pathCells;
-vector<Floor*> pathObjects;  // Objects to render the path
+// Visibility: walls touching each cell (CSR layout, cellWallStart has width*height+1 entries)
+VisibilityMode visibilityMode;
+PortalCuller portalCuller;
+vector<uint32_t> pvsCells;
+vector<uint32_t> cellWallStart;
+vector<uint32_t> cellWallIds;
+vector<uint32_t> visibleWalls;
+vector<uint32_t> wallStamp;   // frame stamp per wall, avoids drawing a wall twice
+uint32_t wallFrame;
+int visibleCellCount;
 
-// random number generator
-mt19937 rng;
+// path index tried by the first getPathLengths (built only for perfect mazes)
+bool pathIndexTried;
 
 //Method to generate the maze
-void initliazeMaze();
-void generateMaze();
+void createMesh(const string &texturePath);
 void createWalls(const string &texturePath);
 void createFloors(const string &floorTexturePath);  // Added method for floor creation
 void createPathMarkers(); // Create visual markers for the path
-void createDirectPath(int startX, int startY, int endX, int endY); // New helper function
+bool computeVisibleWalls(const glm::mat4& view, const glm::mat4& projection); // Visible walls from the camera
+void collectWalls(const vector<uint32_t>& cells); // Walls around the given cells, each once
 };
 
 #endif
\ No newline at end of file